@@ -0,0 +1,77 @@
+#ifndef ALBEDO_ARRAY_H
+#define ALBEDO_ARRAY_H
+
+#include <iostream>
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// All albedo textures as layers of one 2D texture array
+// ------------------------------------------------------------
+// Lets a whole pass share one texture binding; each draw picks its layer.
+// Source images of any size are resampled on the GPU with a linear blit.
+
+extern unsigned int loadTexture(const char* path, bool mips);
+
+struct AlbedoArray {
+    GLuint texture = 0;
+    GLuint readFBO = 0, drawFBO = 0;
+    int width = 2048, height = 1024;
+    int layers = 0, used = 0;
+};
+
+static void initAlbedoArray(AlbedoArray& albedo, int width, int height, int layers) {
+    albedo.width = width;
+    albedo.height = height;
+    albedo.layers = layers;
+
+    glGenTextures(1, &albedo.texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, albedo.texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    trackTexture(albedo.texture, textureBytes(GL_RGBA8, width, height, layers, true), "AlbedoArray", "layers", "albedo");
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glGenFramebuffers(1, &albedo.readFBO);
+    glGenFramebuffers(1, &albedo.drawFBO);
+}
+
+// Loads an image into the next free layer; returns the layer (or -1)
+static int addAlbedoLayer(AlbedoArray& albedo, const char* path) {
+    if (albedo.used >= albedo.layers) {
+        std::cerr << "Albedo array full, dropping " << path << std::endl;
+        return -1;
+    }
+    int layer = albedo.used++;
+
+    GLuint source = loadTexture(path, false);   // only blitted; the array gets its own mips
+    GLint srcW = 0, srcH = 0;
+    glBindTexture(GL_TEXTURE_2D, source);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &srcW);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &srcH);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, albedo.readFBO);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, albedo.drawFBO);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedo.texture, 0, layer);
+    if (srcW > 0 && srcH > 0) {
+        glBlitFramebuffer(0, 0, srcW, srcH, 0, 0, albedo.width, albedo.height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glDeleteTextures(1, &source);
+    untrackTexture(source);
+    return layer;
+}
+
+// Call once every layer is in
+static void finishAlbedoArray(AlbedoArray& albedo) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, albedo.texture);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glDeleteFramebuffers(1, &albedo.readFBO);
+    glDeleteFramebuffers(1, &albedo.drawFBO);
+    albedo.readFBO = albedo.drawFBO = 0;
+}
+
+#endif
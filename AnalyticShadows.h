@@ -0,0 +1,75 @@
+#ifndef ANALYTIC_SHADOWS_H
+#define ANALYTIC_SHADOWS_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "ShadowCascades.h" // ShadowSphere
+
+// ------------------------------------------------------------
+// Analytic sphere shadows (no depth pass)
+// ------------------------------------------------------------
+// Every occluder in the scene is (close enough to) a sphere, so instead of
+// rasterizing shadow maps the fragment shader measures how much of each
+// light's disk is covered by nearby spheres. The CPU hands each body only
+// the few spheres that can actually eclipse it; must match fragment.glsl.
+
+const int MAX_OCCLUDERS = 8;
+
+struct OccluderSet {
+    glm::vec4 spheres[MAX_OCCLUDERS]; // xyz = centre, w = radius
+    int count = 0;
+};
+
+// Directional light of angular radius lightAngle coming from toLight: can
+// occ block any of it for any point on recv?
+static bool canEclipseDirectional(const ShadowSphere& recv, const ShadowSphere& occ,
+                                  const glm::vec3& toLight, float lightAngle) {
+    glm::vec3 d = occ.center - recv.center;
+    float along = glm::dot(d, toLight);
+    if (along + occ.radius <= -recv.radius) return false; // behind the receiver
+    float lateral = glm::length(d - toLight * along);
+    float spread  = recv.radius + occ.radius + std::max(along, 0.0f) * std::tan(lightAngle);
+    return lateral < spread;
+}
+
+// Spherical light at lightPos: occ must sit inside the capsule between the two
+static bool canEclipsePoint(const ShadowSphere& recv, const ShadowSphere& occ,
+                            const glm::vec3& lightPos, float lightRadius) {
+    glm::vec3 seg = lightPos - recv.center;
+    float len2 = glm::dot(seg, seg);
+    float t = len2 > 0.0f ? glm::clamp(glm::dot(occ.center - recv.center, seg) / len2, 0.0f, 1.0f) : 0.0f;
+    float dist = glm::length(occ.center - (recv.center + seg * t));
+    return dist < recv.radius + occ.radius + lightRadius;
+}
+
+// Occluders for spheres[receiver]; lightBody is the sphere the point light
+// sits in (never an occluder of its own light). Largest-looking spheres win
+// when there are more than MAX_OCCLUDERS candidates.
+static void gatherOccluders(OccluderSet& out, int receiver, const std::vector<ShadowSphere>& spheres,
+                            const glm::vec3& toSun, float sunAngle,
+                            bool pointLightOn, const glm::vec3& lightPos, float lightRadius, int lightBody) {
+    const ShadowSphere& recv = spheres[receiver];
+    std::vector<std::pair<float, int>> candidates;
+    for (int i = 0; i < (int)spheres.size(); ++i) {
+        const ShadowSphere& occ = spheres[i];
+        if (i == receiver || !occ.caster) continue;
+        bool blocks = canEclipseDirectional(recv, occ, toSun, sunAngle) ||
+                      (pointLightOn && i != lightBody && canEclipsePoint(recv, occ, lightPos, lightRadius));
+        if (!blocks) continue;
+        float size = occ.radius / std::max(glm::length(occ.center - recv.center), 1e-3f);
+        candidates.push_back({ size, i });
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+
+    out.count = std::min((int)candidates.size(), MAX_OCCLUDERS);
+    for (int k = 0; k < out.count; ++k) {
+        const ShadowSphere& occ = spheres[candidates[k].second];
+        out.spheres[k] = glm::vec4(occ.center, occ.radius);
+    }
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef ASTEROID_BELT_H
+#define ASTEROID_BELT_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include "Shader.h"
+#include "Frustum.h"
+#include "MeshArena.h"
+#include "GpuCulling.h"
+
+// ------------------------------------------------------------
+// Instanced asteroid belt between the Mars and Jupiter orbits
+// ------------------------------------------------------------
+// Every asteroid is the same low-poly rock (generateRockMesh, 80 triangles)
+// with its own orbit, spin and size, packed as two RGBA16F texels (16 bytes)
+// and written once at startup. Asteroid.obj has 13,824 triangles, which at
+// 50k instances is ~690M per frame with the belt in view; the rock is 4M.
+// Only the probe still uses the full mesh.
+// belt_instance.glsl turns that plus `time` into a sphere for GpuCulling.h
+// and a model matrix for vertex.glsl, so the CPU never touches an asteroid
+// after init. Orbit speeds follow Kepler's third law relative to Mars in
+// SolarScene.h (radius 11, speed 0.9).
+
+struct AsteroidBelt {
+    GLsizei count = 0;
+    GLuint instanceBuffer = 0;
+    GLuint VAO = 0;              // arena geometry + visible index at location 4
+    GpuCuller culler;
+    float meshRadius = 1.0f;
+    int layer = 0;               // albedo array layer
+    float innerRadius = 13.0f, outerRadius = 16.5f;   // Mars at 11, Jupiter (radius 5.6) at 18
+    float thickness = 0.25f;     // std-dev of the height above the ecliptic
+    float maxSpeed = 0.0f;       // fastest orbit in world units per unit of time (the inner edge)
+    float lastTime = 0.0f;       // previous cull's time and eye, for the culler's motion margin
+    glm::vec3 lastEye = glm::vec3(0.0f);
+    bool culled = false;
+};
+
+static void initAsteroidBelt(AsteroidBelt& belt, const MeshArena& arena, const MeshRange& mesh,
+                             int layer, GLsizei count, bool useCompute) {
+    belt.count = count;
+    belt.layer = layer;
+    belt.meshRadius = mesh.radius > 0.0f ? mesh.radius : 1.0f;
+
+    const float PI = 3.14159265359f;
+    std::mt19937 rng(1801);   // fixed seed: the same belt every run
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> height(0.0f, belt.thickness);
+
+    belt.maxSpeed = 0.9f * std::pow(11.0f / belt.innerRadius, 1.5f) * belt.innerRadius;
+
+    std::vector<std::uint64_t> packed;
+    packed.reserve(count * 2);
+    for (GLsizei i = 0; i < count; ++i) {
+        // denser towards the middle of the belt
+        float r = glm::mix(belt.innerRadius, belt.outerRadius, 0.5f * (unit(rng) + unit(rng)));
+        float speed = 0.9f * std::pow(11.0f / r, 1.5f);
+        glm::vec4 orbit(r, unit(rng) * 2.0f * PI, speed, height(rng));
+
+        // mostly small rocks, a few big ones
+        float size = 0.01f + 0.05f * std::pow(unit(rng), 4.0f);
+        glm::vec4 spin(unit(rng) * 2.0f * PI, std::asin(unit(rng) * 2.0f - 1.0f),
+                       (unit(rng) * 2.0f - 1.0f) * 3.0f, size);
+
+        packed.push_back(glm::packHalf4x16(orbit));
+        packed.push_back(glm::packHalf4x16(spin));
+    }
+
+    glGenBuffers(1, &belt.instanceBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, belt.instanceBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, packed.size() * sizeof(std::uint64_t), packed.data(), GL_STATIC_DRAW);
+    trackBuffer(belt.instanceBuffer, packed.size() * sizeof(std::uint64_t), "AsteroidBelt", "instances", "instances");
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    initGpuCuller(belt.culler, belt.instanceBuffer, count, mesh, "belt_instance.glsl", useCompute, GL_RGBA16F);
+    belt.culler.program.use();
+    belt.culler.program.setFloat("beltMeshRadius", belt.meshRadius);
+
+    belt.VAO = createArenaVAO(arena);
+    glBindVertexArray(0);
+    bindCulledInstances(belt.culler, belt.VAO, 4);
+}
+
+// Per frame, before the belt is drawn. Uses texture unit `unit` for the instance data.
+static void cullAsteroidBelt(AsteroidBelt& belt, const Frustum& frustum, float time, const glm::vec3& eye, int unit) {
+    if (belt.count == 0) return;
+    // how far an asteroid or the camera got since the last cull (time jumps with the 3 key too)
+    if (belt.culled)
+        belt.culler.motionMargin = belt.maxSpeed * std::abs(time - belt.lastTime) + glm::length(eye - belt.lastEye);
+    belt.lastTime = time;
+    belt.lastEye = eye;
+    belt.culled = true;
+    belt.culler.program.use();
+    belt.culler.program.setFloat("time", time);
+    runGpuCulling(belt.culler, frustum, belt.count, unit);
+}
+
+// Draws the visible asteroids with the main program (vertex.glsl built with
+// belt_instance.glsl, instanceData pointing at the unit culling used)
+static void drawAsteroidBelt(const AsteroidBelt& belt, Shader& shader, float time) {
+    if (belt.count == 0) return;
+    shader.setBool("beltPass", true);
+    shader.setFloat("beltLayer", (float)belt.layer);
+    shader.setFloat("beltMeshRadius", belt.meshRadius);
+    shader.setFloat("time", time);
+    drawCulledInstances(belt.culler, belt.VAO);
+    shader.setBool("beltPass", false);
+}
+
+#endif
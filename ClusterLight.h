@@ -0,0 +1,17 @@
+#ifndef CLUSTER_LIGHT_H
+#define CLUSTER_LIGHT_H
+
+#include <glm/glm.hpp>
+
+// -------------------------------
+// One point light as ClusteredLights.h bins it
+// -------------------------------
+// On its own so the CPU side that moves lights (SolarSystem.h) doesn't need
+// the GL half.
+struct ClusterLight {
+    glm::vec3 position = glm::vec3(0.0f);   // world space
+    float range = 1.0f;                     // no contribution beyond this distance
+    glm::vec3 color = glm::vec3(1.0f);      // already scaled by intensity
+};
+
+#endif
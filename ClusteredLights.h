@@ -0,0 +1,195 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "DrawList.h" // GLStateCache
+#include "ResourceTracker.h"
+#include "ClusterLight.h"
+
+// ------------------------------------------------------------
+// Clustered forward lighting for many small point lights
+// ------------------------------------------------------------
+// The view frustum is cut into CLUSTER_X x CLUSTER_Y screen tiles and
+// CLUSTER_Z depth slices (exponential in view depth, so near slices are
+// thin). Every frame the CPU bins each light's bounding sphere into the
+// clusters it touches and uploads three texture buffers:
+//
+//   lightData      RGBA32F, 2 texels per light: world position + range, colour
+//   clusterLights  RG32UI, per cluster: first entry in lightIndices, count
+//   lightIndices   R32UI, light numbers, grouped by cluster
+//
+// fragment.glsl finds its cluster from gl_FragCoord and view depth and only
+// loops over that cluster's lights. A cluster keeps at most
+// MAX_LIGHTS_PER_CLUSTER of them (the rest are counted as dropped), which
+// is what bounds the per-fragment cost however many lights there are.
+//
+// The buffers are orphaned and refilled each frame rather than going through
+// the StreamBuffer: without texture buffer ranges only its first allocation
+// can be seen by a samplerBuffer, and the draw data already has that spot.
+// These lights don't cast shadows; sun and earthLight stay as they are.
+
+const int CLUSTER_X = 16;
+const int CLUSTER_Y = 9;
+const int CLUSTER_Z = 24;
+const int MAX_LIGHTS_PER_CLUSTER = 32;
+
+struct ClusteredLights {
+    GLuint lightBuffer = 0, lightTexture = 0;
+    GLuint clusterBuffer = 0, clusterTexture = 0;
+    GLuint indexBuffer = 0, indexTexture = 0;
+    float zNear = 0.1f, zFar = 100.0f;      // slice range, the camera's clip planes
+
+    std::vector<glm::vec4> lightData;
+    std::vector<GLuint> clusters;           // first, count per cluster
+    std::vector<GLuint> indices;
+    std::vector<int> bounds;                // scratch: x0 x1 y0 y1 z0 z1 per light
+
+    // last build, for reports
+    GLsizei lights = 0;
+    unsigned long entries = 0, dropped = 0;
+    GLuint maxPerCluster = 0;
+};
+
+static void createLightTexBuffer(GLuint& buffer, GLuint& texture, GLenum format, const char* name) {
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+    trackBuffer(buffer, 16, "ClusteredLights", name, "lights");
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+static void initClusteredLights(ClusteredLights& cl, float zNear, float zFar) {
+    cl.zNear = zNear;
+    cl.zFar = zFar;
+    createLightTexBuffer(cl.lightBuffer, cl.lightTexture, GL_RGBA32F, "lights");
+    createLightTexBuffer(cl.clusterBuffer, cl.clusterTexture, GL_RG32UI, "clusters");
+    createLightTexBuffer(cl.indexBuffer, cl.indexTexture, GL_R32UI, "light indices");
+}
+
+static int clusterSlice(const ClusteredLights& cl, float viewDepth) {
+    float s = std::log(viewDepth / cl.zNear) / std::log(cl.zFar / cl.zNear) * CLUSTER_Z;
+    return glm::clamp((int)std::floor(s), 0, CLUSTER_Z - 1);
+}
+
+// Bins `lights` for this frame's camera and uploads everything
+static void buildLightClusters(ClusteredLights& cl, const std::vector<ClusterLight>& lights,
+                               const glm::mat4& view, const glm::mat4& projection) {
+    const int clusterCount = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+    cl.lightData.clear();
+    cl.bounds.clear();
+    cl.clusters.assign(clusterCount * 2, 0);
+    cl.indices.clear();
+    cl.entries = cl.dropped = 0;
+    cl.maxPerCluster = 0;
+
+    // cluster ranges per light (-1 = off screen)
+    for (const ClusterLight& light : lights) {
+        cl.lightData.push_back(glm::vec4(light.position, light.range));
+        cl.lightData.push_back(glm::vec4(light.color, 0.0f));
+
+        glm::vec3 c = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float nearZ = -c.z - light.range, farZ = -c.z + light.range;
+        if (farZ < cl.zNear || nearZ > cl.zFar) { cl.bounds.insert(cl.bounds.end(), 6, -1); continue; }
+
+        int x0 = 0, x1 = CLUSTER_X - 1, y0 = 0, y1 = CLUSTER_Y - 1;
+        if (nearZ > cl.zNear) {
+            // the sphere's view-space box is entirely in front of the camera, so its
+            // projected corners bound the sphere on screen
+            float loX = 1e9f, loY = 1e9f, hiX = -1e9f, hiY = -1e9f;
+            for (int k = 0; k < 8; ++k) {
+                glm::vec3 corner = c + light.range * glm::vec3((k & 1) ? 1.0f : -1.0f,
+                                                               (k & 2) ? 1.0f : -1.0f,
+                                                               (k & 4) ? 1.0f : -1.0f);
+                glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+                loX = std::min(loX, clip.x / clip.w);
+                hiX = std::max(hiX, clip.x / clip.w);
+                loY = std::min(loY, clip.y / clip.w);
+                hiY = std::max(hiY, clip.y / clip.w);
+            }
+            if (hiX < -1.0f || loX > 1.0f || hiY < -1.0f || loY > 1.0f) {
+                cl.bounds.insert(cl.bounds.end(), 6, -1);
+                continue;
+            }
+            x0 = glm::clamp((int)std::floor((loX * 0.5f + 0.5f) * CLUSTER_X), 0, CLUSTER_X - 1);
+            x1 = glm::clamp((int)std::floor((hiX * 0.5f + 0.5f) * CLUSTER_X), 0, CLUSTER_X - 1);
+            y0 = glm::clamp((int)std::floor((loY * 0.5f + 0.5f) * CLUSTER_Y), 0, CLUSTER_Y - 1);
+            y1 = glm::clamp((int)std::floor((hiY * 0.5f + 0.5f) * CLUSTER_Y), 0, CLUSTER_Y - 1);
+        }
+        int z0 = clusterSlice(cl, std::max(nearZ, cl.zNear));
+        int z1 = clusterSlice(cl, std::min(farZ, cl.zFar));
+        int b[6] = { x0, x1, y0, y1, z0, z1 };
+        cl.bounds.insert(cl.bounds.end(), b, b + 6);
+    }
+
+    // counting sort: counts (capped), prefix sums, then fill
+    auto forEachCluster = [&](int l, auto&& fn) {
+        const int* b = &cl.bounds[l * 6];
+        if (b[0] < 0) return;
+        for (int z = b[4]; z <= b[5]; ++z)
+            for (int y = b[2]; y <= b[3]; ++y)
+                for (int x = b[0]; x <= b[1]; ++x)
+                    fn((z * CLUSTER_Y + y) * CLUSTER_X + x);
+    };
+    for (int l = 0; l < (int)lights.size(); ++l) {
+        forEachCluster(l, [&](int i) {
+            if (cl.clusters[i * 2 + 1] < (GLuint)MAX_LIGHTS_PER_CLUSTER) cl.clusters[i * 2 + 1]++;
+            else cl.dropped++;
+        });
+    }
+    GLuint first = 0;
+    for (int i = 0; i < clusterCount; ++i) {
+        cl.clusters[i * 2] = first;
+        first += cl.clusters[i * 2 + 1];
+        cl.maxPerCluster = std::max(cl.maxPerCluster, cl.clusters[i * 2 + 1]);
+        cl.clusters[i * 2 + 1] = 0;   // refilled below
+    }
+    cl.indices.resize(first);
+    for (int l = 0; l < (int)lights.size(); ++l) {
+        forEachCluster(l, [&](int i) {
+            GLuint& count = cl.clusters[i * 2 + 1];
+            if (count < (GLuint)MAX_LIGHTS_PER_CLUSTER) cl.indices[cl.clusters[i * 2] + count++] = (GLuint)l;
+        });
+    }
+    cl.lights = (GLsizei)lights.size();
+    cl.entries = first;
+
+    auto upload = [](GLuint buffer, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, std::max(bytes, (size_t)16), nullptr, GL_STREAM_DRAW);   // orphan
+        resizeTrackedBuffer(buffer, std::max(bytes, (size_t)16));
+        if (bytes) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    };
+    upload(cl.lightBuffer, cl.lightData.data(), cl.lightData.size() * sizeof(glm::vec4));
+    upload(cl.clusterBuffer, cl.clusters.data(), cl.clusters.size() * sizeof(GLuint));
+    upload(cl.indexBuffer, cl.indices.data(), cl.indices.size() * sizeof(GLuint));
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    size_t cpuBytes = cl.lightData.capacity() * sizeof(glm::vec4) + cl.bounds.capacity() * sizeof(int) +
+                      (cl.clusters.capacity() + cl.indices.capacity()) * sizeof(GLuint);
+    trackCpu(&cl, cpuBytes, "ClusteredLights", "binning lists", "lights");
+}
+
+// Binds the three buffers to firstUnit..firstUnit+2 and sets the per-frame
+// cluster uniforms on `shader` (which must be current)
+static void bindClusteredLights(const ClusteredLights& cl, Shader& shader, GLStateCache& cache,
+                                int firstUnit, int framebufferWidth, int framebufferHeight) {
+    cache.bindTexture(firstUnit,     GL_TEXTURE_BUFFER, cl.lightTexture);
+    cache.bindTexture(firstUnit + 1, GL_TEXTURE_BUFFER, cl.clusterTexture);
+    cache.bindTexture(firstUnit + 2, GL_TEXTURE_BUFFER, cl.indexTexture);
+
+    float logRange = std::log(cl.zFar / cl.zNear);
+    shader.setVec3("clusterGrid", glm::vec3(CLUSTER_X, CLUSTER_Y, CLUSTER_Z));
+    shader.setVec4("clusterParams", glm::vec4((float)framebufferWidth / CLUSTER_X,
+                                              (float)framebufferHeight / CLUSTER_Y,
+                                              CLUSTER_Z / logRange,
+                                              -CLUSTER_Z * std::log(cl.zNear) / logRange));
+}
+
+#endif
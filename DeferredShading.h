@@ -0,0 +1,141 @@
+#ifndef DEFERRED_SHADING_H
+#define DEFERRED_SHADING_H
+
+#include <iostream>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "DrawList.h" // GLStateCache
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// Deferred shading path (--shading=deferred)
+// ------------------------------------------------------------
+// The opaque draws run gbuffer.frag, which only writes material data; all
+// lighting then happens once per covered pixel in a fullscreen pass
+// (deferred_light.frag), however much overdraw the geometry had. Both paths
+// share lighting.glsl, so they shade identically.
+//
+// G-buffer, 16 bytes a pixel:
+//   albedo  RGBA8    rgb albedo, a = DrawFlags
+//   normal  RGBA16UI octahedral normal (2 x unorm16), analytic occluder first/count
+//   depth   DEPTH24  world position is rebuilt from it
+//
+// The lighting pass reads depth, so it can't have that texture attached: it
+// draws into `lit` (RGBA16F, linear) alone and skips empty pixels itself. The
+// blended rings and the occlusion proxies then go into forwardFBO (lit + the
+// G-buffer depth), and PostProcess.h takes lit from there.
+
+struct GBuffer {
+    int width = 0, height = 0;
+    GLuint albedo = 0, normal = 0, depth = 0, lit = 0;
+    GLuint geometryFBO = 0;   // albedo + normal + depth
+    GLuint lightFBO = 0;      // lit only
+    GLuint forwardFBO = 0;    // lit + depth
+    GLuint emptyVAO = 0;      // fullscreen triangle, no attributes
+};
+
+static GLuint createGBufferTexture(GLenum internalFormat, GLenum format, GLenum type, int width, int height,
+                                   const char* name) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    trackTexture(tex, textureBytes(internalFormat, width, height, 1, false), "GBuffer", name, "gbuffer");
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);   // integer formats need it
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+static void checkGBufferFBO(const char* name) {
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "GBuffer: " << name << " framebuffer incomplete" << std::endl;
+}
+
+// (Re)creates every target when the framebuffer size changes; cheap no-op otherwise
+static void resizeGBuffer(GBuffer& gb, int width, int height) {
+    if (gb.width == width && gb.height == height) return;
+    if (gb.geometryFBO) {
+        GLuint textures[4] = { gb.albedo, gb.normal, gb.depth, gb.lit };
+        GLuint fbos[3] = { gb.geometryFBO, gb.lightFBO, gb.forwardFBO };
+        glDeleteTextures(4, textures);
+        for (GLuint t : textures) untrackTexture(t);
+        glDeleteFramebuffers(3, fbos);
+    } else {
+        glGenVertexArrays(1, &gb.emptyVAO);
+    }
+    gb.width = width;
+    gb.height = height;
+
+    gb.albedo = createGBufferTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height, "albedo");
+    gb.normal = createGBufferTexture(GL_RGBA16UI, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, width, height, "normal");
+    gb.depth  = createGBufferTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, width, height, "depth");
+    gb.lit    = createGBufferTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height, "lit");
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);   // bloom downsamples it
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const GLenum two[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glGenFramebuffers(1, &gb.geometryFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, gb.geometryFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gb.albedo, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gb.normal, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gb.depth, 0);
+    glDrawBuffers(2, two);
+    checkGBufferFBO("geometry");
+
+    glGenFramebuffers(1, &gb.lightFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, gb.lightFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gb.lit, 0);
+    checkGBufferFBO("light");
+
+    glGenFramebuffers(1, &gb.forwardFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, gb.forwardFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gb.lit, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gb.depth, 0);
+    checkGBufferFBO("forward");
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Opaque draws with the gbuffer.frag program go after this
+static void beginGeometryPass(const GBuffer& gb) {
+    const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLuint zeroU[4] = { 0, 0, 0, 0 };
+    glBindFramebuffer(GL_FRAMEBUFFER, gb.geometryFBO);
+    glViewport(0, 0, gb.width, gb.height);
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glClearBufferuiv(GL_COLOR, 1, zeroU);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+// Fullscreen lighting into gb.lit. The caller has made lightShader current and
+// set its lighting.glsl uniforms; the G-buffer goes on firstUnit..firstUnit+2.
+static void runLightingPass(const GBuffer& gb, Shader& lightShader, GLStateCache& cache, int firstUnit,
+                            const glm::mat4& inverseViewProjection, const glm::vec4& clearColor) {
+    glBindFramebuffer(GL_FRAMEBUFFER, gb.lightFBO);
+    glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    cache.bindTexture(firstUnit,     GL_TEXTURE_2D, gb.albedo);
+    cache.bindTexture(firstUnit + 1, GL_TEXTURE_2D, gb.normal);
+    cache.bindTexture(firstUnit + 2, GL_TEXTURE_2D, gb.depth);
+    lightShader.setMat4("inverseViewProjection", inverseViewProjection);
+
+    glDisable(GL_DEPTH_TEST);
+    cache.bindVertexArray(gb.emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    cache.stats.glCalls++;
+    cache.stats.submits++;
+    cache.stats.draws++;
+    cache.stats.triangles++;
+    glEnable(GL_DEPTH_TEST);
+}
+
+// Blended / depth-only draws on top of the lit image
+static void beginForwardOverGBuffer(const GBuffer& gb) {
+    glBindFramebuffer(GL_FRAMEBUFFER, gb.forwardFBO);
+}
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "MeshArena.h"
+#include "StreamBuffer.h"
+#include "AnalyticShadows.h" // OccluderSet
+
+// ------------------------------------------------------------
+// Draw packets, sort keys, GL state cache and indirect submission
+// ------------------------------------------------------------
+// Passes collect DrawPackets instead of calling GL directly. A packet list
+// is sorted by a 64-bit key so draws sharing program/mesh/texture end up
+// next to each other (and opaque draws go front to back).
+//
+// Key layout (most significant first):
+//   opaque:       pass:4 | program:8 | mesh:12 | texture:12 | depth:24 | unused:4
+//   transparent:  pass:4 | far-to-near depth:24 | program:8 | mesh:12 | texture:12 | unused:4
+// Blended draws have to go back to front whatever they bind, so there the
+// depth outranks the state. The program only goes into the key: a range is
+// drawn with whatever program its pass binds, so a packet doesn't carry one.
+//
+// All lists of a frame are then packed into one DrawBatch: per-draw data
+// (model matrix, albedo layer, flags, analytic occluders) goes into a
+// texture buffer the shaders index by draw ID, and every list becomes a
+// range of indirect commands over the shared MeshArena. Both are written
+// into the frame's StreamBuffer. A pass is then a
+// single glMultiDrawElementsIndirect, or on plain GL 3.3 a loop of
+// glDrawElementsBaseVertex with the draw ID set as a constant attribute.
+
+enum DrawPass {
+    PASS_OPAQUE      = 0,
+    PASS_TRANSPARENT = 1,
+};
+
+enum DrawFlags {
+    DRAW_SUN        = 1 << 0,   // fragment.glsl isSun
+    DRAW_EARTH      = 1 << 1,   // fragment.glsl isEarth
+    DRAW_ALPHA_TEST = 1 << 2,   // point_shadow.frag discards texels below half alpha (rings)
+};
+
+struct DrawPacket {
+    uint64_t key = 0;
+    MeshRange mesh;
+    int layer = 0;                            // albedo array layer
+    glm::mat4 model = glm::mat4(1.0f);
+    unsigned int flags = 0;
+    const OccluderSet* occluders = nullptr;   // analytic shadow mode only
+    int tag = -1;                             // caller's object id, kept through sorting
+};
+
+// depth01: 0 = nearest; opaque passes draw front to back, transparent back to front
+static uint64_t makeDrawKey(unsigned int pass, GLuint program, GLuint mesh, GLuint texture, float depth01) {
+    uint64_t depth = (uint64_t)(glm::clamp(depth01, 0.0f, 1.0f) * 16777215.0f);
+    if (pass == PASS_TRANSPARENT) {
+        return ((uint64_t)(pass    & 0xF)   << 60) |
+               ((16777215u - depth)          << 36) |
+               ((uint64_t)(program & 0xFF)  << 28) |
+               ((uint64_t)(mesh    & 0xFFF) << 16) |
+               ((uint64_t)(texture & 0xFFF) << 4);
+    }
+    return ((uint64_t)(pass    & 0xF)   << 60) |
+           ((uint64_t)(program & 0xFF)  << 52) |
+           ((uint64_t)(mesh    & 0xFFF) << 40) |
+           ((uint64_t)(texture & 0xFFF) << 28) |
+           (depth << 4);
+}
+
+struct DrawList {
+    std::vector<DrawPacket> packets;
+
+    void clear() { packets.clear(); }
+
+    void add(unsigned int pass, GLuint program, const MeshRange& mesh, int layer,
+             const glm::mat4& model, float depth01 = 0.0f, unsigned int flags = 0,
+             const OccluderSet* occluders = nullptr, int tag = -1) {
+        DrawPacket p;
+        p.key = makeDrawKey(pass, program, (GLuint)mesh.id, (GLuint)layer, depth01);
+        p.mesh = mesh;
+        p.layer = layer;
+        p.model = model;
+        p.flags = flags;
+        p.occluders = occluders;
+        p.tag = tag;
+        packets.push_back(p);
+    }
+
+    void sort() {
+        std::stable_sort(packets.begin(), packets.end(),
+                         [](const DrawPacket& a, const DrawPacket& b) { return a.key < b.key; });
+    }
+};
+
+// GL calls issued (and avoided) by the draw path in one frame
+struct DrawStats {
+    unsigned long glCalls = 0;        // every GL entry point the draw path actually called
+    unsigned long draws = 0;          // draws the GPU sees (commands inside a multi-draw count)
+    unsigned long submits = 0;        // draw entry points called
+    unsigned long triangles = 0;      // submitted, before clipping and conditional rendering
+    unsigned long programBinds = 0, vaoBinds = 0, textureBinds = 0;
+    unsigned long redundantSkipped = 0;
+};
+
+// -------------------------------------------
+// Remembers what is bound so repeated binds become no-ops
+// -------------------------------------------
+// Anything that touches GL state behind the cache's back must call
+// invalidate() afterwards.
+struct GLStateCache {
+    static const int UNITS = 16;
+
+    GLuint program = ~0u, vao = ~0u, indirect = ~0u;
+    GLuint textures[UNITS];
+    int activeUnit = -1;
+    DrawStats stats;
+
+    GLStateCache() { invalidate(); }
+
+    void invalidate() {
+        program = vao = indirect = ~0u;
+        for (GLuint& t : textures) t = ~0u;
+        activeUnit = -1;
+    }
+
+    void useProgram(GLuint id) {
+        if (id == program) { stats.redundantSkipped++; return; }
+        glUseProgram(id);
+        program = id;
+        stats.programBinds++;
+        stats.glCalls++;
+    }
+
+    void bindVertexArray(GLuint id) {
+        if (id == vao) { stats.redundantSkipped++; return; }
+        glBindVertexArray(id);
+        vao = id;
+        stats.vaoBinds++;
+        stats.glCalls++;
+    }
+
+    void bindIndirectBuffer(GLuint id) {
+        if (id == indirect) { stats.redundantSkipped++; return; }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, id);
+        indirect = id;
+        stats.glCalls++;
+    }
+
+    // one texture per unit is tracked regardless of target
+    void bindTexture(int unit, GLenum target, GLuint id) {
+        if (textures[unit] == id) { stats.redundantSkipped++; return; }
+        if (activeUnit != unit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            activeUnit = unit;
+            stats.glCalls++;
+        }
+        glBindTexture(target, id);
+        textures[unit] = id;
+        stats.textureBinds++;
+        stats.glCalls++;
+    }
+};
+
+// -------------------------------------------
+// One frame's worth of draws, packed for indirect submission
+// -------------------------------------------
+struct DrawCommand {              // layout fixed by GL (DrawElementsIndirectCommand)
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;          // = draw ID
+};
+
+const int DRAW_DATA_TEXELS = 5;   // model columns 0-3, then (layer, flags, first occluder texel, occluder count)
+
+struct DrawBatch {
+    GLuint dataTexture = 0;
+    bool multiDraw = false;       // GL 4.3 / ARB_multi_draw_indirect + ARB_base_instance
+    GLint texelAlign = 16;        // GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT
+    StreamAlloc dataAlloc, commandAlloc;   // where this frame's data went in the stream
+    GLuint streamBuffer = 0;
+    std::vector<glm::vec4> data;
+    std::vector<glm::vec4> occluderData;
+    std::vector<DrawCommand> commands;
+    std::vector<int> tags;        // DrawPacket::tag per command
+    struct Range { GLsizei first = 0, count = 0; };
+    std::vector<Range> ranges;
+};
+
+static void initDrawBatch(DrawBatch& batch, bool multiDraw, const StreamBuffer& stream) {
+    batch.multiDraw = multiDraw;
+    glGenTextures(1, &batch.dataTexture);
+    if (stream.persistent) glGetIntegerv(GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT, &batch.texelAlign);
+}
+
+static void beginDrawBatch(DrawBatch& batch) {
+    batch.data.clear();
+    batch.occluderData.clear();
+    batch.commands.clear();
+    batch.tags.clear();
+    batch.ranges.clear();
+}
+
+// Sorts the list and appends it as one range; returns the range index
+static int addToDrawBatch(DrawBatch& batch, DrawList& list) {
+    list.sort();
+    DrawBatch::Range range;
+    range.first = (GLsizei)batch.commands.size();
+    for (const DrawPacket& p : list.packets) {
+        DrawCommand cmd;
+        cmd.count = (GLuint)p.mesh.indexCount;
+        cmd.instanceCount = 1;
+        cmd.firstIndex = p.mesh.firstIndex;
+        cmd.baseVertex = p.mesh.baseVertex;
+        cmd.baseInstance = (GLuint)batch.commands.size();
+        batch.commands.push_back(cmd);
+        batch.tags.push_back(p.tag);
+
+        // occluder offsets are relative to the occluder block until upload
+        int occFirst = (int)batch.occluderData.size();
+        int occCount = p.occluders ? p.occluders->count : 0;
+        for (int k = 0; k < occCount; ++k) batch.occluderData.push_back(p.occluders->spheres[k]);
+
+        for (int c = 0; c < 4; ++c) batch.data.push_back(p.model[c]);
+        batch.data.push_back(glm::vec4((float)p.layer, (float)p.flags, (float)occFirst, (float)occCount));
+    }
+    range.count = (GLsizei)list.packets.size();
+    batch.ranges.push_back(range);
+    return (int)batch.ranges.size() - 1;
+}
+
+// Writes draw data + commands into the stream. Must be the frame's first
+// stream allocation: without texture buffer ranges the data texture can only
+// look at the start of the buffer.
+static void writeDrawBatch(DrawBatch& batch, StreamBuffer& stream) {
+    GLsizei drawCount = (GLsizei)batch.commands.size();
+    float occluderBase = (float)(drawCount * DRAW_DATA_TEXELS);
+    for (GLsizei d = 0; d < drawCount; ++d) batch.data[d * DRAW_DATA_TEXELS + 4].z += occluderBase;
+    batch.data.insert(batch.data.end(), batch.occluderData.begin(), batch.occluderData.end());
+
+    batch.dataAlloc = streamWrite(stream, batch.data.data(), batch.data.size() * sizeof(glm::vec4), batch.texelAlign);
+    if (batch.multiDraw)
+        batch.commandAlloc = streamWrite(stream, batch.commands.data(), batch.commands.size() * sizeof(DrawCommand), 4);
+}
+
+// After flushStream: points the data texture on `unit` at this frame's data
+static void bindDrawBatch(DrawBatch& batch, const StreamBuffer& stream, GLStateCache& cache, int unit) {
+    cache.bindTexture(unit, GL_TEXTURE_BUFFER, batch.dataTexture);
+    if (stream.persistent)
+        glTexBufferRange(GL_TEXTURE_BUFFER, GL_RGBA32F, stream.buffer, batch.dataAlloc.offset, batch.dataAlloc.size);
+    else
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, stream.buffer);
+    cache.stats.glCalls++;
+
+    batch.streamBuffer = stream.buffer;
+}
+
+// Draws one range with whatever program the caller has bound
+static void submitDrawBatch(const DrawBatch& batch, int rangeIndex, const MeshArena& arena, GLStateCache& cache) {
+    const DrawBatch::Range& range = batch.ranges[rangeIndex];
+    if (range.count == 0) return;
+    cache.bindVertexArray(arena.VAO);
+
+    if (batch.multiDraw) {
+        if (range.first + range.count > arena.maxDraws || !batch.commandAlloc.ptr) {
+            std::cerr << "DrawBatch: more draws than the arena's draw-ID buffer or the stream holds" << std::endl;
+            return;
+        }
+        cache.bindIndirectBuffer(batch.streamBuffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                    (void*)(batch.commandAlloc.offset + range.first * sizeof(DrawCommand)),
+                                    range.count, 0);
+        cache.stats.glCalls++;
+        cache.stats.submits++;
+        cache.stats.draws += range.count;
+        for (GLsizei i = range.first; i < range.first + range.count; ++i)
+            cache.stats.triangles += batch.commands[i].count / 3;
+        return;
+    }
+
+    for (GLsizei i = range.first; i < range.first + range.count; ++i) {
+        const DrawCommand& cmd = batch.commands[i];
+        glVertexAttribI1ui(3, cmd.baseInstance);
+        glDrawElementsBaseVertex(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT,
+                                 (void*)(cmd.firstIndex * sizeof(GLuint)), cmd.baseVertex);
+        cache.stats.glCalls += 2;
+        cache.stats.submits++;
+        cache.stats.draws++;
+        cache.stats.triangles += cmd.count / 3;
+    }
+}
+
+// Draws the k-th command of a range on its own (e.g. under conditional rendering)
+static void submitDrawBatchCommand(const DrawBatch& batch, int rangeIndex, GLsizei k,
+                                   const MeshArena& arena, GLStateCache& cache) {
+    GLsizei i = batch.ranges[rangeIndex].first + k;
+    const DrawCommand& cmd = batch.commands[i];
+    cache.bindVertexArray(arena.VAO);
+
+    if (batch.multiDraw) {
+        if (i >= arena.maxDraws || !batch.commandAlloc.ptr) return;
+        cache.bindIndirectBuffer(batch.streamBuffer);
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                               (void*)(batch.commandAlloc.offset + i * sizeof(DrawCommand)));
+        cache.stats.glCalls++;
+    } else {
+        glVertexAttribI1ui(3, cmd.baseInstance);
+        glDrawElementsBaseVertex(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT,
+                                 (void*)(cmd.firstIndex * sizeof(GLuint)), cmd.baseVertex);
+        cache.stats.glCalls += 2;
+    }
+    cache.stats.submits++;
+    cache.stats.draws++;
+    cache.stats.triangles += cmd.count / 3;
+}
+
+#endif
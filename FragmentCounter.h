@@ -0,0 +1,55 @@
+#ifndef FRAGMENT_COUNTER_H
+#define FRAGMENT_COUNTER_H
+
+// ------------------------------------------------------------
+// Counts the fragments a pass shades (GL_SAMPLES_PASSED)
+// ------------------------------------------------------------
+// fragment.glsl never discards or writes depth, so early-z stays on and every
+// sample that passes the depth test is a shaded fragment. Two queries
+// alternate between frames and a result is only read once the GPU reports it
+// available, so the count lags a frame or two but never stalls.
+
+struct FragmentCounter {
+    GLuint queries[2] = { 0, 0 };
+    bool pending[2] = { false, false };
+    int current = 0;
+    unsigned long long total = 0;   // summed results since the last reset
+    unsigned long results = 0;
+};
+
+static void initFragmentCounter(FragmentCounter& counter) {
+    glGenQueries(2, counter.queries);
+}
+
+static void beginFragmentCount(FragmentCounter& counter) {
+    // previous use of this slot is collected first (or dropped if still in flight)
+    int q = counter.current;
+    if (counter.pending[q]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(counter.queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 samples = 0;
+            glGetQueryObjectui64v(counter.queries[q], GL_QUERY_RESULT, &samples);
+            counter.total += samples;
+            counter.results++;
+        }
+        counter.pending[q] = false;
+    }
+    glBeginQuery(GL_SAMPLES_PASSED, counter.queries[q]);
+}
+
+static void endFragmentCount(FragmentCounter& counter) {
+    glEndQuery(GL_SAMPLES_PASSED);
+    counter.pending[counter.current] = true;
+    counter.current ^= 1;
+}
+
+// average fragments per counted frame, then starts a new window
+static unsigned long long takeFragmentAverage(FragmentCounter& counter) {
+    unsigned long long avg = counter.results ? counter.total / counter.results : 0;
+    counter.total = 0;
+    counter.results = 0;
+    return avg;
+}
+
+#endif
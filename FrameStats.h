@@ -0,0 +1,135 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <string>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "SolarScene.h"
+#include "Overlay.h"
+
+// ------------------------------------------------------------
+// Frame counters for the overlay and the stats file
+// ------------------------------------------------------------
+// A FrameStatsWindow adds up frames until someone takes its averages: the
+// overlay every quarter second, the stats file every --stats-interval.
+//
+//   cpu ms   sum of the CPU zone averages except "swap" (that's vsync waiting)
+//   gpu ms   sum of the GPU zone averages (they never overlap)
+//   culled   occlusion proxies found hidden (results two frames old) and
+//            belt asteroids outside the frustum (on the compute path the
+//            count read back a frame or two late, like the belt's triangles)
+//
+// The stats file is one JSON object, rewritten through a temporary file and
+// rename() so a script polling it never reads half a file.
+
+struct FrameCounters {
+    double fps = 0.0, frameMs = 0.0;
+    double cpuMs = 0.0, gpuMs = 0.0;
+    double draws = 0.0, glCalls = 0.0, triangles = 0.0;   // per frame
+    double occludedBodies = 0.0;
+    double culledAsteroids = 0.0;
+    unsigned long long textureBytes = 0, bufferBytes = 0, cpuBytes = 0;   // ResourceTracker.h totals
+};
+
+struct FrameStatsWindow {
+    double seconds = 0.0;
+    unsigned long frames = 0;
+    DrawStats draws;
+    unsigned long occludedBodies = 0, culledAsteroids = 0;
+};
+
+// Call once per frame after renderSolarFrame
+static void addFrameStats(FrameStatsWindow& window, const SolarScene& scene, float deltaTime) {
+    const DrawStats& s = scene.glState.stats;
+    window.seconds += deltaTime;
+    window.frames++;
+    window.draws.draws += s.draws;
+    window.draws.glCalls += s.glCalls;
+    window.draws.triangles += s.triangles;
+    window.occludedBodies += scene.occludedBodies;
+    if (scene.belt.count > 0)
+        window.culledAsteroids += scene.belt.count - scene.belt.culler.visibleCount;
+}
+
+// Averages since the last call; starts a new window
+static FrameCounters takeFrameCounters(FrameStatsWindow& window, const SolarScene& scene) {
+    FrameCounters c;
+    double frames = window.frames ? (double)window.frames : 1.0;
+    c.fps = window.seconds > 0.0 ? window.frames / window.seconds : 0.0;
+    c.frameMs = window.seconds * 1000.0 / frames;
+    for (const ProfileZone& zone : scene.profiler.zones) {
+        if (zone.gpu) c.gpuMs += profileAverage(zone);
+        else if (zone.name != "swap") c.cpuMs += profileAverage(zone);
+    }
+    c.draws = window.draws.draws / frames;
+    c.glCalls = window.draws.glCalls / frames;
+    c.triangles = window.draws.triangles / frames;
+    c.occludedBodies = window.occludedBodies / frames;
+    c.culledAsteroids = window.culledAsteroids / frames;
+    ResourceTotals memory = resourceTotals();
+    c.textureBytes = memory.textures;
+    c.bufferBytes = memory.buffers;
+    c.cpuBytes = memory.cpu;
+    window = FrameStatsWindow();
+    return c;
+}
+
+static std::string formatCount(double n) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(n >= 1e6 ? 2 : 0);
+    if (n >= 1e6) out << n / 1e6 << "M";
+    else out << n;
+    return out.str();
+}
+
+// The overlay's lines; the frame time line turns red below 60 fps
+static void setOverlayCounters(Overlay& overlay, const FrameCounters& c, double overlayGpuMs) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "FPS " << c.fps << "  FRAME " << std::setprecision(2)
+         << c.frameMs << " MS";
+    setOverlayLine(overlay, 0, line.str(), c.frameMs > 1000.0 / 60.0 ? 1 : 0);
+    line.str("");
+    line << std::fixed << std::setprecision(2) << "CPU " << c.cpuMs << " MS  GPU " << c.gpuMs << " MS";
+    setOverlayLine(overlay, 1, line.str());
+    setOverlayLine(overlay, 2, "DRAWS " + formatCount(c.draws) + "  GL CALLS " + formatCount(c.glCalls));
+    setOverlayLine(overlay, 3, "TRIANGLES " + formatCount(c.triangles));
+    setOverlayLine(overlay, 4, "CULLED " + formatCount(c.occludedBodies) + " BODIES, " +
+                               formatCount(c.culledAsteroids) + " ASTEROIDS");
+    line.str("");
+    line << std::fixed << std::setprecision(1) << "TEXTURES " << megabytes(c.textureBytes) << " MB  BUFFERS "
+         << megabytes(c.bufferBytes) << " MB";
+    setOverlayLine(overlay, 5, line.str());
+    line.str("");
+    line << std::fixed << std::setprecision(3) << "OVERLAY " << overlayGpuMs << " MS GPU";
+    setOverlayLine(overlay, 6, line.str());
+}
+
+static bool writeStatsFile(const std::string& path, const FrameCounters& c) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp);
+        if (!out) {
+            std::cerr << "Could not write stats file " << temp << std::endl;
+            return false;
+        }
+        out << std::fixed << std::setprecision(3)
+            << "{\"time\": " << (long long)std::time(nullptr)
+            << ", \"fps\": " << c.fps << ", \"frame_ms\": " << c.frameMs
+            << ", \"cpu_ms\": " << c.cpuMs << ", \"gpu_ms\": " << c.gpuMs
+            << ", \"draws\": " << c.draws << ", \"gl_calls\": " << c.glCalls
+            << ", \"triangles\": " << c.triangles << ", \"occluded_bodies\": " << c.occludedBodies
+            << ", \"culled_asteroids\": " << c.culledAsteroids
+            << ", \"texture_bytes\": " << c.textureBytes << ", \"buffer_bytes\": " << c.bufferBytes
+            << ", \"cpu_bytes\": " << c.cpuBytes << "}\n";
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Could not replace stats file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
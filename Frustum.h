@@ -0,0 +1,46 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// -------------------------------
+// View frustum as 6 planes
+// -------------------------------
+// Planes are stored as (n, d) with n pointing into the frustum, so a point p
+// is inside a plane when dot(n, p) + d >= 0.
+struct Frustum {
+    glm::vec4 planes[6]; // left, right, bottom, top, near, far
+};
+
+// Gribb/Hartmann plane extraction from a combined projection * view matrix
+static Frustum extractFrustum(const glm::mat4& viewProj) {
+    Frustum f;
+    glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+    f.planes[0] = row3 + row0;
+    f.planes[1] = row3 - row0;
+    f.planes[2] = row3 + row1;
+    f.planes[3] = row3 - row1;
+    f.planes[4] = row3 + row2;
+    f.planes[5] = row3 - row2;
+
+    for (glm::vec4& p : f.planes) {
+        float len = glm::length(glm::vec3(p));
+        p = p / len;
+    }
+    return f;
+}
+
+// true when the sphere touches or is inside the frustum
+static bool sphereInFrustum(const Frustum& f, const glm::vec3& center, float radius) {
+    for (const glm::vec4& p : f.planes) {
+        if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+#endif
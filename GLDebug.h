@@ -0,0 +1,674 @@
+#ifndef GL_DEBUG_H
+#define GL_DEBUG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+// ------------------------------------------------------------
+// GL call counting and performance lint (build with -DSOLAR_GL_DEBUG)
+// ------------------------------------------------------------
+// Include right after GL/glew.h, before anything that calls GL. With
+// SOLAR_GL_DEBUG defined, the entry points the frame uses become macros that
+// go through a wrapper with the call site (__FILE__:__LINE__), which
+//
+//   counts calls per entry point and per frame (draws separately),
+//   flags redundant state changes: binding what is already bound, enabling
+//     what is already on, setting a uniform to the value it already has,
+//   flags implicit sync points: GL_QUERY_RESULT without a successful
+//     GL_QUERY_RESULT_AVAILABLE first, glClientWaitSync that had to wait,
+//     and glBufferSubData /
+//     synchronized glMapBufferRange on a buffer a draw read in the last
+//     GL_DEBUG_FRAMES_IN_FLIGHT frames (glBufferData orphans, so it's fine),
+//   counts glGetUniformLocation lookups (a string hash per uniform set).
+//
+// glDebugEndFrame() closes a frame and checks it against the --gl-budget
+// limits; printGLDebugReport() prints per-frame averages, the worst frame,
+// the busiest entry points and every flagged call site, then starts over.
+// Without SOLAR_GL_DEBUG all of that compiles to nothing and the budget
+// option is ignored with a warning.
+//
+// The layer keeps its own copy of the state, so it also sees what
+// GLStateCache skips or misses. Calls from other translation units
+// (ObjLoader.cpp) aren't wrapped; they only run at load time. Wrappers that
+// can flag something take the call site; those that only count or track
+// state don't.
+//
+// glFinish and glReadPixels aren't wrapped: their only callers, bench's
+// glFinish after every measured frame and Golden.h's readback, are syncs on
+// purpose.
+
+// --gl-budget=calls=400,draws=64,redundant=0,sync=0 (per frame, -1 = no limit)
+struct GLDebugBudget {
+    long calls = -1, draws = -1, redundant = -1, sync = -1;
+};
+
+static GLDebugBudget parseGLDebugBudget(const std::string& spec) {
+    GLDebugBudget budget;
+    size_t start = 0;
+    while (start < spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) end = spec.size();
+        std::string item = spec.substr(start, end - start);
+        size_t eq = item.find('=');
+        std::string key = item.substr(0, eq);
+        long value = eq == std::string::npos ? -1 : std::atol(item.c_str() + eq + 1);
+        if (key == "calls") budget.calls = value;
+        else if (key == "draws") budget.draws = value;
+        else if (key == "redundant") budget.redundant = value;
+        else if (key == "sync") budget.sync = value;
+        else std::cerr << "--gl-budget: unknown limit '" << key << "'" << std::endl;
+        start = end + 1;
+    }
+    return budget;
+}
+
+#ifdef SOLAR_GL_DEBUG
+
+const unsigned long GL_DEBUG_FRAMES_IN_FLIGHT = 2;
+
+struct GLDebugFrame {
+    unsigned long calls = 0, draws = 0;
+    unsigned long redundantBinds = 0, redundantUniforms = 0;
+    unsigned long syncPoints = 0, uniformLookups = 0;
+};
+
+struct GLDebugState {
+    unsigned long frame = 1;
+    GLDebugFrame current, total, worst;   // worst = the frame with the most calls
+    unsigned long frames = 0;
+    std::map<std::string, unsigned long> calls;       // entry point -> calls since the last report
+    std::map<std::string, unsigned long> redundant;   // "glBindTexture  DrawList.h:160" -> count
+    std::map<std::string, unsigned long> syncs;
+
+    GLDebugBudget budget;
+    unsigned long budgetFailures = 0;
+    std::string firstFailure;
+
+    // shadow state; ~0u / false = not known yet
+    GLuint program = ~0u, vao = ~0u, drawFramebuffer = ~0u, readFramebuffer = ~0u;
+    GLenum activeUnit = ~0u;
+    std::map<std::pair<GLenum, GLenum>, GLuint> textures;        // (unit, target)
+    std::map<GLenum, GLuint> buffers;                            // non-indexed targets
+    std::map<std::pair<GLenum, GLuint>, GLuint> indexedBuffers;  // (target, index)
+    std::map<GLuint, std::vector<GLuint>> vaoBuffers;            // attribute + element buffers
+    std::map<GLuint, GLuint> textureBuffers;                     // buffer texture -> buffer
+    std::map<GLuint, unsigned long> bufferLastRead;              // frame a draw last read it
+    std::map<std::pair<GLuint, GLint>, std::vector<unsigned char>> uniforms;
+    std::map<GLenum, bool> caps;
+    bool depthMaskKnown = false, colorMaskKnown = false, depthFuncKnown = false;
+    bool blendFuncKnown = false, viewportKnown = false;
+    GLboolean depthMask = GL_TRUE, colorMask[4] = {};
+    GLenum depthFunc = 0, blendSrc = 0, blendDst = 0;
+    GLint viewport[4] = {};
+    GLuint availableQuery = 0;   // last query whose GL_QUERY_RESULT_AVAILABLE came back true
+};
+
+static GLDebugState glDebug;
+
+static std::string glDebugSite(const char* what, const char* file, int line) {
+    const char* slash = std::strrchr(file, '/');
+    return std::string(what) + "  " + (slash ? slash + 1 : file) + ":" + std::to_string(line);
+}
+
+static void glDebugCall(const char* name) {
+    glDebug.current.calls++;
+    glDebug.calls[name]++;
+}
+
+static void glDebugAddVaoBuffer(GLuint buffer) {
+    std::vector<GLuint>& buffers = glDebug.vaoBuffers[glDebug.vao];
+    if (buffer && std::find(buffers.begin(), buffers.end(), buffer) == buffers.end()) buffers.push_back(buffer);
+}
+
+static void glDebugRedundantBind(const char* name, const char* file, int line) {
+    glDebug.current.redundantBinds++;
+    glDebug.redundant[glDebugSite(name, file, line)]++;
+}
+
+static void glDebugSync(const char* what, const char* file, int line) {
+    glDebug.current.syncPoints++;
+    glDebug.syncs[glDebugSite(what, file, line)]++;
+}
+
+// Everything the next draw can read: the VAO's buffers, the indirect buffer,
+// indexed bindings and the sources of bound buffer textures
+static void glDebugMarkDrawReads() {
+    auto mark = [](GLuint buffer) { if (buffer) glDebug.bufferLastRead[buffer] = glDebug.frame; };
+    auto vao = glDebug.vaoBuffers.find(glDebug.vao);
+    if (vao != glDebug.vaoBuffers.end())
+        for (GLuint b : vao->second) mark(b);
+    mark(glDebug.buffers[GL_DRAW_INDIRECT_BUFFER]);
+    for (const auto& binding : glDebug.indexedBuffers) mark(binding.second);
+    for (const auto& bound : glDebug.textures)
+        if (bound.first.second == GL_TEXTURE_BUFFER) {
+            auto source = glDebug.textureBuffers.find(bound.second);
+            if (source != glDebug.textureBuffers.end()) mark(source->second);
+        }
+}
+
+static bool glDebugInFlight(GLuint buffer) {
+    auto it = glDebug.bufferLastRead.find(buffer);
+    return it != glDebug.bufferLastRead.end() && glDebug.frame - it->second <= GL_DEBUG_FRAMES_IN_FLIGHT;
+}
+
+// ---- state ----
+
+static void glDebugUseProgram(GLuint program, const char* file, int line) {
+    glDebugCall("glUseProgram");
+    if (program == glDebug.program) glDebugRedundantBind("glUseProgram", file, line);
+    glDebug.program = program;
+    glUseProgram(program);
+}
+
+static void glDebugBindVertexArray(GLuint vao, const char* file, int line) {
+    glDebugCall("glBindVertexArray");
+    if (vao == glDebug.vao) glDebugRedundantBind("glBindVertexArray", file, line);
+    glDebug.vao = vao;
+    glBindVertexArray(vao);
+}
+
+static void glDebugActiveTexture(GLenum unit, const char* file, int line) {
+    glDebugCall("glActiveTexture");
+    if (unit == glDebug.activeUnit) glDebugRedundantBind("glActiveTexture", file, line);
+    glDebug.activeUnit = unit;
+    glActiveTexture(unit);
+}
+
+static void glDebugBindTexture(GLenum target, GLuint texture, const char* file, int line) {
+    glDebugCall("glBindTexture");
+    auto key = std::make_pair(glDebug.activeUnit, target);
+    auto it = glDebug.textures.find(key);
+    if (glDebug.activeUnit != ~0u && it != glDebug.textures.end() && it->second == texture)
+        glDebugRedundantBind("glBindTexture", file, line);
+    glDebug.textures[key] = texture;
+    glBindTexture(target, texture);
+}
+
+static void glDebugBindBuffer(GLenum target, GLuint buffer, const char* file, int line) {
+    glDebugCall("glBindBuffer");
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        // part of the VAO's state
+        if (glDebug.vao != ~0u) glDebugAddVaoBuffer(buffer);
+    } else {
+        auto it = glDebug.buffers.find(target);
+        if (it != glDebug.buffers.end() && it->second == buffer) glDebugRedundantBind("glBindBuffer", file, line);
+        glDebug.buffers[target] = buffer;
+    }
+    glBindBuffer(target, buffer);
+}
+
+static void glDebugBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    glDebugCall("glBindBufferBase");
+    glDebug.indexedBuffers[std::make_pair(target, index)] = buffer;
+    glDebug.buffers[target] = buffer;   // also the generic binding
+    glBindBufferBase(target, index, buffer);
+}
+
+static void glDebugBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    glDebugCall("glBindBufferRange");
+    glDebug.indexedBuffers[std::make_pair(target, index)] = buffer;
+    glDebug.buffers[target] = buffer;
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+static void glDebugBindFramebuffer(GLenum target, GLuint framebuffer, const char* file, int line) {
+    glDebugCall("glBindFramebuffer");
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if ((!draw || glDebug.drawFramebuffer == framebuffer) && (!read || glDebug.readFramebuffer == framebuffer))
+        glDebugRedundantBind("glBindFramebuffer", file, line);
+    if (draw) glDebug.drawFramebuffer = framebuffer;
+    if (read) glDebug.readFramebuffer = framebuffer;
+    glBindFramebuffer(target, framebuffer);
+}
+
+static void glDebugEnable(GLenum cap, const char* file, int line) {
+    glDebugCall("glEnable");
+    auto it = glDebug.caps.find(cap);
+    if (it != glDebug.caps.end() && it->second) glDebugRedundantBind("glEnable", file, line);
+    glDebug.caps[cap] = true;
+    glEnable(cap);
+}
+
+static void glDebugDisable(GLenum cap, const char* file, int line) {
+    glDebugCall("glDisable");
+    auto it = glDebug.caps.find(cap);
+    if (it != glDebug.caps.end() && !it->second) glDebugRedundantBind("glDisable", file, line);
+    glDebug.caps[cap] = false;
+    glDisable(cap);
+}
+
+static void glDebugDepthMask(GLboolean flag, const char* file, int line) {
+    glDebugCall("glDepthMask");
+    if (glDebug.depthMaskKnown && glDebug.depthMask == flag) glDebugRedundantBind("glDepthMask", file, line);
+    glDebug.depthMaskKnown = true;
+    glDebug.depthMask = flag;
+    glDepthMask(flag);
+}
+
+static void glDebugColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a, const char* file, int line) {
+    glDebugCall("glColorMask");
+    GLboolean mask[4] = { r, g, b, a };
+    if (glDebug.colorMaskKnown && std::equal(mask, mask + 4, glDebug.colorMask))
+        glDebugRedundantBind("glColorMask", file, line);
+    glDebug.colorMaskKnown = true;
+    std::copy(mask, mask + 4, glDebug.colorMask);
+    glColorMask(r, g, b, a);
+}
+
+static void glDebugDepthFunc(GLenum func, const char* file, int line) {
+    glDebugCall("glDepthFunc");
+    if (glDebug.depthFuncKnown && glDebug.depthFunc == func) glDebugRedundantBind("glDepthFunc", file, line);
+    glDebug.depthFuncKnown = true;
+    glDebug.depthFunc = func;
+    glDepthFunc(func);
+}
+
+static void glDebugBlendFunc(GLenum src, GLenum dst, const char* file, int line) {
+    glDebugCall("glBlendFunc");
+    if (glDebug.blendFuncKnown && glDebug.blendSrc == src && glDebug.blendDst == dst)
+        glDebugRedundantBind("glBlendFunc", file, line);
+    glDebug.blendFuncKnown = true;
+    glDebug.blendSrc = src;
+    glDebug.blendDst = dst;
+    glBlendFunc(src, dst);
+}
+
+static void glDebugViewport(GLint x, GLint y, GLsizei w, GLsizei h, const char* file, int line) {
+    glDebugCall("glViewport");
+    GLint v[4] = { x, y, w, h };
+    if (glDebug.viewportKnown && std::equal(v, v + 4, glDebug.viewport)) glDebugRedundantBind("glViewport", file, line);
+    glDebug.viewportKnown = true;
+    std::copy(v, v + 4, glDebug.viewport);
+    glViewport(x, y, w, h);
+}
+
+static void glDebugTexBuffer(GLenum target, GLenum format, GLuint buffer) {
+    glDebugCall("glTexBuffer");
+    glDebug.textureBuffers[glDebug.textures[std::make_pair(glDebug.activeUnit, target)]] = buffer;
+    glTexBuffer(target, format, buffer);
+}
+
+static void glDebugTexBufferRange(GLenum target, GLenum format, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    glDebugCall("glTexBufferRange");
+    glDebug.textureBuffers[glDebug.textures[std::make_pair(glDebug.activeUnit, target)]] = buffer;
+    glTexBufferRange(target, format, buffer, offset, size);
+}
+
+static void glDebugVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                                       const void* pointer) {
+    glDebugCall("glVertexAttribPointer");
+    glDebugAddVaoBuffer(glDebug.buffers[GL_ARRAY_BUFFER]);
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+static void glDebugVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+    glDebugCall("glVertexAttribIPointer");
+    glDebugAddVaoBuffer(glDebug.buffers[GL_ARRAY_BUFFER]);
+    glVertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+static void glDebugVertexAttribI1ui(GLuint index, GLuint x) {
+    glDebugCall("glVertexAttribI1ui");
+    glVertexAttribI1ui(index, x);
+}
+
+// ---- uniforms ----
+
+static GLint glDebugGetUniformLocation(GLuint program, const GLchar* name) {
+    glDebugCall("glGetUniformLocation");
+    glDebug.current.uniformLookups++;
+    return glGetUniformLocation(program, name);
+}
+
+// true (and counted) if `location` of the current program already holds these bytes
+static bool glDebugSameUniform(const char* name, GLint location, const void* value, size_t bytes,
+                               const char* file, int line) {
+    glDebugCall(name);
+    if (location < 0) return false;
+    std::vector<unsigned char>& held = glDebug.uniforms[std::make_pair(glDebug.program, location)];
+    const unsigned char* v = (const unsigned char*)value;
+    if (held.size() == bytes && std::equal(v, v + bytes, held.begin())) {
+        glDebug.current.redundantUniforms++;
+        glDebug.redundant[glDebugSite(name, file, line)]++;
+        return true;
+    }
+    held.assign(v, v + bytes);
+    return false;
+}
+
+// redundant sets are still passed through: the lint reports, it doesn't fix
+static void glDebugUniform1i(GLint location, GLint v, const char* file, int line) {
+    glDebugSameUniform("glUniform1i", location, &v, sizeof(v), file, line);
+    glUniform1i(location, v);
+}
+
+static void glDebugUniform1f(GLint location, GLfloat v, const char* file, int line) {
+    glDebugSameUniform("glUniform1f", location, &v, sizeof(v), file, line);
+    glUniform1f(location, v);
+}
+
+static void glDebugUniform2fv(GLint location, GLsizei count, const GLfloat* v, const char* file, int line) {
+    glDebugSameUniform("glUniform2fv", location, v, sizeof(GLfloat) * 2 * count, file, line);
+    glUniform2fv(location, count, v);
+}
+
+static void glDebugUniform3fv(GLint location, GLsizei count, const GLfloat* v, const char* file, int line) {
+    glDebugSameUniform("glUniform3fv", location, v, sizeof(GLfloat) * 3 * count, file, line);
+    glUniform3fv(location, count, v);
+}
+
+static void glDebugUniform4fv(GLint location, GLsizei count, const GLfloat* v, const char* file, int line) {
+    glDebugSameUniform("glUniform4fv", location, v, sizeof(GLfloat) * 4 * count, file, line);
+    glUniform4fv(location, count, v);
+}
+
+static void glDebugUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v,
+                                    const char* file, int line) {
+    glDebugSameUniform("glUniformMatrix4fv", location, v, sizeof(GLfloat) * 16 * count, file, line);
+    glUniformMatrix4fv(location, count, transpose, v);
+}
+
+// ---- draws ----
+
+static void glDebugDraw(const char* name, unsigned long draws) {
+    glDebugCall(name);
+    glDebug.current.draws += draws;
+    glDebugMarkDrawReads();
+}
+
+static void glDebugDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    glDebugDraw("glDrawArrays", 1);
+    glDrawArrays(mode, first, count);
+}
+
+static void glDebugDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+    glDebugDraw("glDrawArraysInstanced", 1);
+    glDrawArraysInstanced(mode, first, count, instances);
+}
+
+static void glDebugDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                          GLint baseVertex) {
+    glDebugDraw("glDrawElementsBaseVertex", 1);
+    glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+static void glDebugDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                                   GLsizei instances, GLint baseVertex) {
+    glDebugDraw("glDrawElementsInstancedBaseVertex", 1);
+    glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+}
+
+static void glDebugDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect) {
+    glDebugDraw("glDrawElementsIndirect", 1);
+    glDrawElementsIndirect(mode, type, indirect);
+}
+
+static void glDebugMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount,
+                                             GLsizei stride) {
+    glDebugDraw("glMultiDrawElementsIndirect", drawCount);
+    glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+}
+
+static void glDebugDispatchCompute(GLuint x, GLuint y, GLuint z) {
+    glDebugCall("glDispatchCompute");
+    glDebugMarkDrawReads();
+    glDispatchCompute(x, y, z);
+}
+
+static void glDebugClear(GLbitfield mask) {
+    glDebugCall("glClear");
+    glClear(mask);
+}
+
+// ---- uploads and sync points ----
+
+static GLuint glDebugBoundBuffer(GLenum target) {
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        auto vao = glDebug.vaoBuffers.find(glDebug.vao);
+        return vao != glDebug.vaoBuffers.end() && !vao->second.empty() ? vao->second.back() : 0;
+    }
+    return glDebug.buffers[target];
+}
+
+static void glDebugBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    glDebugCall("glBufferData");
+    glDebug.bufferLastRead.erase(glDebugBoundBuffer(target));   // new storage, nothing in flight
+    glBufferData(target, size, data, usage);
+}
+
+static void glDebugBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data,
+                                 const char* file, int line) {
+    glDebugCall("glBufferSubData");
+    if (glDebugInFlight(glDebugBoundBuffer(target))) glDebugSync("glBufferSubData on a buffer in flight", file, line);
+    glBufferSubData(target, offset, size, data);
+}
+
+static void* glDebugMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access,
+                                   const char* file, int line) {
+    glDebugCall("glMapBufferRange");
+    bool synchronized = !(access & (GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_PERSISTENT_BIT));
+    if (synchronized && glDebugInFlight(glDebugBoundBuffer(target)))
+        glDebugSync("glMapBufferRange on a buffer in flight", file, line);
+    return glMapBufferRange(target, offset, length, access);
+}
+
+static void glDebugTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei w, GLsizei h, GLint border,
+                              GLenum format, GLenum type, const void* pixels) {
+    glDebugCall("glTexImage2D");
+    glTexImage2D(target, level, internalFormat, w, h, border, format, type, pixels);
+}
+
+static void glDebugGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params, const char* file, int line) {
+    glDebugCall("glGetQueryObjectuiv");
+    if (pname == GL_QUERY_RESULT && id != glDebug.availableQuery)
+        glDebugSync("glGetQueryObjectuiv(GL_QUERY_RESULT) not known to be ready", file, line);
+    glGetQueryObjectuiv(id, pname, params);
+    if (pname == GL_QUERY_RESULT_AVAILABLE) glDebug.availableQuery = *params ? id : 0;
+}
+
+static void glDebugGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params, const char* file, int line) {
+    glDebugCall("glGetQueryObjectui64v");
+    if (pname == GL_QUERY_RESULT && id != glDebug.availableQuery)
+        glDebugSync("glGetQueryObjectui64v(GL_QUERY_RESULT) not known to be ready", file, line);
+    glGetQueryObjectui64v(id, pname, params);
+}
+
+static GLenum glDebugClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout, const char* file, int line) {
+    glDebugCall("glClientWaitSync");
+    GLenum result = glClientWaitSync(sync, flags, timeout);
+    if (timeout > 0 && result != GL_ALREADY_SIGNALED) glDebugSync("glClientWaitSync waited", file, line);
+    return result;
+}
+
+static void glDebugGetIntegerv(GLenum pname, GLint* data) {
+    glDebugCall("glGetIntegerv");
+    glGetIntegerv(pname, data);
+}
+
+#undef glUseProgram
+#undef glBindVertexArray
+#undef glActiveTexture
+#undef glBindTexture
+#undef glBindBuffer
+#undef glBindBufferBase
+#undef glBindBufferRange
+#undef glBindFramebuffer
+#undef glEnable
+#undef glDisable
+#undef glDepthMask
+#undef glColorMask
+#undef glDepthFunc
+#undef glBlendFunc
+#undef glViewport
+#undef glTexBuffer
+#undef glTexBufferRange
+#undef glVertexAttribPointer
+#undef glVertexAttribIPointer
+#undef glVertexAttribI1ui
+#undef glGetUniformLocation
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform2fv
+#undef glUniform3fv
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glDrawArrays
+#undef glDrawArraysInstanced
+#undef glDrawElementsBaseVertex
+#undef glDrawElementsInstancedBaseVertex
+#undef glDrawElementsIndirect
+#undef glMultiDrawElementsIndirect
+#undef glDispatchCompute
+#undef glClear
+#undef glBufferData
+#undef glBufferSubData
+#undef glMapBufferRange
+#undef glTexImage2D
+#undef glGetQueryObjectuiv
+#undef glGetQueryObjectui64v
+#undef glClientWaitSync
+#undef glGetIntegerv
+
+#define glUseProgram(p) glDebugUseProgram(p, __FILE__, __LINE__)
+#define glBindVertexArray(v) glDebugBindVertexArray(v, __FILE__, __LINE__)
+#define glActiveTexture(u) glDebugActiveTexture(u, __FILE__, __LINE__)
+#define glBindTexture(t, tex) glDebugBindTexture(t, tex, __FILE__, __LINE__)
+#define glBindBuffer(t, b) glDebugBindBuffer(t, b, __FILE__, __LINE__)
+#define glBindBufferBase(t, i, b) glDebugBindBufferBase(t, i, b)
+#define glBindBufferRange(t, i, b, o, s) glDebugBindBufferRange(t, i, b, o, s)
+#define glBindFramebuffer(t, f) glDebugBindFramebuffer(t, f, __FILE__, __LINE__)
+#define glEnable(c) glDebugEnable(c, __FILE__, __LINE__)
+#define glDisable(c) glDebugDisable(c, __FILE__, __LINE__)
+#define glDepthMask(f) glDebugDepthMask(f, __FILE__, __LINE__)
+#define glColorMask(r, g, b, a) glDebugColorMask(r, g, b, a, __FILE__, __LINE__)
+#define glDepthFunc(f) glDebugDepthFunc(f, __FILE__, __LINE__)
+#define glBlendFunc(s, d) glDebugBlendFunc(s, d, __FILE__, __LINE__)
+#define glViewport(x, y, w, h) glDebugViewport(x, y, w, h, __FILE__, __LINE__)
+#define glTexBuffer(t, f, b) glDebugTexBuffer(t, f, b)
+#define glTexBufferRange(t, f, b, o, s) glDebugTexBufferRange(t, f, b, o, s)
+#define glVertexAttribPointer(i, s, t, n, st, p) glDebugVertexAttribPointer(i, s, t, n, st, p)
+#define glVertexAttribIPointer(i, s, t, st, p) glDebugVertexAttribIPointer(i, s, t, st, p)
+#define glVertexAttribI1ui(i, x) glDebugVertexAttribI1ui(i, x)
+#define glGetUniformLocation(p, n) glDebugGetUniformLocation(p, n)
+#define glUniform1i(l, v) glDebugUniform1i(l, v, __FILE__, __LINE__)
+#define glUniform1f(l, v) glDebugUniform1f(l, v, __FILE__, __LINE__)
+#define glUniform2fv(l, c, v) glDebugUniform2fv(l, c, v, __FILE__, __LINE__)
+#define glUniform3fv(l, c, v) glDebugUniform3fv(l, c, v, __FILE__, __LINE__)
+#define glUniform4fv(l, c, v) glDebugUniform4fv(l, c, v, __FILE__, __LINE__)
+#define glUniformMatrix4fv(l, c, t, v) glDebugUniformMatrix4fv(l, c, t, v, __FILE__, __LINE__)
+#define glDrawArrays(m, f, c) glDebugDrawArrays(m, f, c)
+#define glDrawArraysInstanced(m, f, c, n) glDebugDrawArraysInstanced(m, f, c, n)
+#define glDrawElementsBaseVertex(m, c, t, i, b) glDebugDrawElementsBaseVertex(m, c, t, i, b)
+#define glDrawElementsInstancedBaseVertex(m, c, t, i, n, b) glDebugDrawElementsInstancedBaseVertex(m, c, t, i, n, b)
+#define glDrawElementsIndirect(m, t, i) glDebugDrawElementsIndirect(m, t, i)
+#define glMultiDrawElementsIndirect(m, t, i, n, s) glDebugMultiDrawElementsIndirect(m, t, i, n, s)
+#define glDispatchCompute(x, y, z) glDebugDispatchCompute(x, y, z)
+#define glClear(m) glDebugClear(m)
+#define glBufferData(t, s, d, u) glDebugBufferData(t, s, d, u)
+#define glBufferSubData(t, o, s, d) glDebugBufferSubData(t, o, s, d, __FILE__, __LINE__)
+#define glMapBufferRange(t, o, l, a) glDebugMapBufferRange(t, o, l, a, __FILE__, __LINE__)
+#define glTexImage2D(t, l, i, w, h, b, f, ty, p) glDebugTexImage2D(t, l, i, w, h, b, f, ty, p)
+#define glGetQueryObjectuiv(i, p, v) glDebugGetQueryObjectuiv(i, p, v, __FILE__, __LINE__)
+#define glGetQueryObjectui64v(i, p, v) glDebugGetQueryObjectui64v(i, p, v, __FILE__, __LINE__)
+#define glClientWaitSync(s, f, t) glDebugClientWaitSync(s, f, t, __FILE__, __LINE__)
+#define glGetIntegerv(p, d) glDebugGetIntegerv(p, d)
+
+// Call after initialization, so load-time calls aren't in the first frame
+static void initGLDebug(const std::string& budget) {
+    GLDebugBudget limits = parseGLDebugBudget(budget);
+    glDebug.current = glDebug.total = glDebug.worst = GLDebugFrame();
+    glDebug.frames = 0;
+    glDebug.calls.clear();
+    glDebug.redundant.clear();
+    glDebug.syncs.clear();
+    glDebug.budget = limits;
+}
+
+// Once per frame, before the swap; checkBudget = false for warm-up frames
+static void glDebugEndFrame(bool checkBudget = true) {
+    const GLDebugFrame& f = glDebug.current;
+    GLDebugBudget b = checkBudget ? glDebug.budget : GLDebugBudget();
+    std::string over;
+    if (b.calls >= 0 && (long)f.calls > b.calls) over += " calls " + std::to_string(f.calls);
+    if (b.draws >= 0 && (long)f.draws > b.draws) over += " draws " + std::to_string(f.draws);
+    if (b.redundant >= 0 && (long)(f.redundantBinds + f.redundantUniforms) > b.redundant)
+        over += " redundant " + std::to_string(f.redundantBinds + f.redundantUniforms);
+    if (b.sync >= 0 && (long)f.syncPoints > b.sync) over += " sync " + std::to_string(f.syncPoints);
+    if (!over.empty() && glDebug.budgetFailures++ == 0) {
+        glDebug.firstFailure = "frame " + std::to_string(glDebug.frame) + ":" + over;
+        std::cerr << "GL budget exceeded in " << glDebug.firstFailure << std::endl;
+    }
+
+    GLDebugFrame& t = glDebug.total;
+    t.calls += f.calls;
+    t.draws += f.draws;
+    t.redundantBinds += f.redundantBinds;
+    t.redundantUniforms += f.redundantUniforms;
+    t.syncPoints += f.syncPoints;
+    t.uniformLookups += f.uniformLookups;
+    if (f.calls > glDebug.worst.calls) glDebug.worst = f;
+    glDebug.frames++;
+    glDebug.current = GLDebugFrame();
+    glDebug.frame++;
+}
+
+static unsigned long glDebugBudgetFailures() {
+    return glDebug.budgetFailures;
+}
+
+static void printGLDebugReport(std::ostream& out) {
+    if (glDebug.frames == 0) return;
+    double n = (double)glDebug.frames;
+    const GLDebugFrame& t = glDebug.total;
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << "GL debug (" << glDebug.frames << " frames): " << t.calls / n << " calls/frame (worst "
+        << glDebug.worst.calls << "), " << t.draws / n << " draws, " << t.redundantBinds / n
+        << " redundant binds, " << t.redundantUniforms / n << " redundant uniform sets, "
+        << t.uniformLookups / n << " uniform lookups, " << t.syncPoints / n << " sync points" << std::endl;
+
+    auto printTop = [&](const std::map<std::string, unsigned long>& counts, const char* title, size_t limit) {
+        std::vector<std::pair<unsigned long, std::string>> sorted;
+        for (const auto& c : counts) sorted.push_back({ c.second, c.first });
+        std::sort(sorted.rbegin(), sorted.rend());
+        if (!sorted.empty()) out << "  " << title << std::endl;
+        for (size_t i = 0; i < sorted.size() && i < limit; ++i)
+            out << "    " << std::setw(8) << sorted[i].first / n << "/frame  " << sorted[i].second << std::endl;
+    };
+    printTop(glDebug.calls, "busiest entry points:", 10);
+    printTop(glDebug.redundant, "redundant (call site):", 12);
+    printTop(glDebug.syncs, "sync points (call site):", 12);
+    if (glDebug.budgetFailures)
+        out << "  budget exceeded in " << glDebug.budgetFailures << " frames, first " << glDebug.firstFailure << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+
+    glDebug.total = glDebug.worst = GLDebugFrame();
+    glDebug.frames = 0;
+    glDebug.calls.clear();
+    glDebug.redundant.clear();
+    glDebug.syncs.clear();
+}
+
+#else
+
+static void initGLDebug(const std::string& budget) {
+    if (!budget.empty())
+        std::cerr << "--gl-budget needs a build with -DSOLAR_GL_DEBUG; ignored" << std::endl;
+}
+static void glDebugEndFrame(bool = true) {}
+static unsigned long glDebugBudgetFailures() { return 0; }
+static void printGLDebugReport(std::ostream&) {}
+
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+// ------------------------------------------------------------
+// Golden images: stored reference frames and frame times for bench
+// ------------------------------------------------------------
+// bench --golden=dir renders one fixed frame per path and size and compares
+// it with dir/<path>_<W>x<H>.ppm; --golden-update writes them instead. The
+// references come from whatever renderer made them (llvmpipe under xvfb-run
+// is the one everyone has), so keep one directory per renderer.
+//
+// Pixels are compared like pixelmatch does: the squared difference in YIQ,
+// weighted the way the eye sees it, so an edge antialiased a little
+// differently or dithered noise doesn't count while a missing planet does.
+// A pixel differs when its delta is over `threshold` (0..1 of the largest
+// possible); the image fails when more than `maxDiffering` of its pixels do.
+// A failed compare leaves <name>.actual.ppm and <name>.diff.ppm (differing
+// pixels red over a dimmed copy) next to the reference.
+//
+// dir/timings.txt keeps each run's average frame ms from the last update that
+// ran it, with the renderer they were measured on; a run that is `maxSlowdown`
+// slower fails.
+// On another renderer the times aren't comparable and are only printed.
+
+struct GoldenImage {
+    int width = 0, height = 0;
+    std::vector<unsigned char> rgb;   // top row first
+};
+
+struct GoldenTolerance {
+    float threshold = 0.1f;           // per-pixel YIQ delta, 0..1
+    float maxDiffering = 0.001f;      // fraction of pixels allowed over it
+    float maxSlowdown = 0.25f;        // avg frame ms over the stored one
+};
+
+struct GoldenCompare {
+    long differing = 0;
+    float worstDelta = 0.0f;          // 0..1
+    bool sizeMismatch = false;
+};
+
+// The window's back buffer as RGB, flipped to top row first
+static GoldenImage readGoldenFrame(int width, int height) {
+    GoldenImage image;
+    image.width = width;
+    image.height = height;
+    std::vector<unsigned char> rows((size_t)width * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, rows.data());   // a deliberate sync, not linted
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    image.rgb.resize(rows.size());
+    size_t stride = (size_t)width * 3;
+    for (int y = 0; y < height; ++y)
+        std::copy(rows.begin() + (height - 1 - y) * stride, rows.begin() + (height - y) * stride,
+                  image.rgb.begin() + y * stride);
+    return image;
+}
+
+// binary PPM (P6), no dependency and any viewer opens it
+static bool writeGoldenImage(const std::string& path, const GoldenImage& image) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "golden: can't write " << path << std::endl;
+        return false;
+    }
+    out << "P6\n" << image.width << " " << image.height << "\n255\n";
+    out.write((const char*)image.rgb.data(), (std::streamsize)image.rgb.size());
+    return true;
+}
+
+static bool readGoldenImage(const std::string& path, GoldenImage& image) {
+    std::ifstream in(path, std::ios::binary);
+    std::string magic;
+    int maxValue = 0;
+    if (!(in >> magic >> image.width >> image.height >> maxValue) || magic != "P6" || maxValue != 255) return false;
+    in.get();   // the one whitespace byte before the pixels
+    image.rgb.resize((size_t)image.width * image.height * 3);
+    in.read((char*)image.rgb.data(), (std::streamsize)image.rgb.size());
+    return (size_t)in.gcount() == image.rgb.size();
+}
+
+// pixelmatch's colour delta: squared YIQ distance, 35215 at most
+static float goldenPixelDelta(const unsigned char* a, const unsigned char* b) {
+    float r1 = a[0], g1 = a[1], b1 = a[2], r2 = b[0], g2 = b[1], b2 = b[2];
+    float y = (r1 - r2) * 0.29889531f + (g1 - g2) * 0.58662247f + (b1 - b2) * 0.11448223f;
+    float i = (r1 - r2) * 0.59597799f - (g1 - g2) * 0.27417610f - (b1 - b2) * 0.32180189f;
+    float q = (r1 - r2) * 0.21147017f - (g1 - g2) * 0.52261711f + (b1 - b2) * 0.31114694f;
+    return (0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q) / 35215.0f;
+}
+
+static GoldenCompare compareGoldenImages(const GoldenImage& expected, const GoldenImage& actual, float threshold,
+                                         GoldenImage* diff) {
+    GoldenCompare result;
+    if (expected.width != actual.width || expected.height != actual.height) {
+        result.sizeMismatch = true;
+        return result;
+    }
+    // pixelmatch squares its threshold too: 0.1 means a delta of 0.01 here
+    float limit = threshold * threshold;
+    if (diff) *diff = actual;
+    for (size_t p = 0; p < actual.rgb.size(); p += 3) {
+        float delta = goldenPixelDelta(&expected.rgb[p], &actual.rgb[p]);
+        result.worstDelta = std::max(result.worstDelta, std::sqrt(delta));
+        bool differs = delta > limit;
+        if (differs) result.differing++;
+        if (diff) {
+            unsigned char* d = &diff->rgb[p];
+            if (differs) {
+                d[0] = 255; d[1] = 0; d[2] = 0;
+            } else {
+                d[0] = d[1] = d[2] = (unsigned char)(64 + (d[0] * 0.299f + d[1] * 0.587f + d[2] * 0.114f) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+// timings.txt: "renderer <string>" then "<name> <avg ms>" per line
+struct GoldenTimings {
+    std::string renderer;
+    std::map<std::string, float> avgMs;
+};
+
+static GoldenTimings readGoldenTimings(const std::string& path) {
+    GoldenTimings timings;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("renderer ", 0) == 0) {
+            timings.renderer = line.substr(9);
+            continue;
+        }
+        std::istringstream ss(line);
+        std::string name;
+        float ms = 0.0f;
+        if (ss >> name >> ms) timings.avgMs[name] = ms;
+    }
+    return timings;
+}
+
+static bool writeGoldenTimings(const std::string& path, const GoldenTimings& timings) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "golden: can't write " << path << std::endl;
+        return false;
+    }
+    out << "renderer " << timings.renderer << "\n";
+    for (const auto& t : timings.avgMs) out << t.first << " " << t.second << "\n";
+    return true;
+}
+
+#endif
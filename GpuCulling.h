@@ -0,0 +1,258 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <vector>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "Frustum.h"
+#include "MeshArena.h"
+#include "DrawList.h" // DrawCommand
+
+// ------------------------------------------------------------
+// Frustum culling of large instance sets on the GPU
+// ------------------------------------------------------------
+// The caller owns an instance buffer (any layout) and a small GLSL include
+// that declares how to read it:
+//
+//     uniform samplerBuffer instanceData;     // bound by the culler
+//     vec4 InstanceSphere(int i);             // xyz = world centre, w = radius
+//
+// Every instance is tested against the frustum and the indices of the
+// visible ones are written, compacted, into visibleBuffer. Instanced draws
+// read that buffer as a uint attribute with divisor 1 and look their own
+// data up by index, so the CPU never touches individual instances.
+//
+// GL 4.3: cull.comp appends with an atomic counter that is also the
+// instanceCount of an indirect command. The draw never waits for the CPU;
+// only for the stats is the count copied into one of CULL_SLOTS small
+// buffers and read back once its fence has signalled, a frame or two late.
+// GL 3.3: cull_feedback.vert/.geom run one point per instance with the
+// rasterizer off; the geometry shader only emits visible instances and
+// transform feedback captures them. The count comes from a
+// PRIMITIVES_WRITTEN query, and that is never waited for: each cull captures
+// into the next of CULL_SLOTS ranges of visibleBuffer with its own
+// query, and the draw uses the newest range whose count is available (like
+// OcclusionQueries.h, GL_QUERY_RESULT_AVAILABLE first). When the GPU keeps
+// up that's this frame's; otherwise the visible set is a frame or two old.
+// So that nothing is missing at the screen edges then, this path culls
+// against grown spheres: by CULL_SLOTS - 1 times the caller's
+// motionMargin (how far an instance or the camera moves per frame), and by
+// as many frames of the camera's last turn, scaled with view distance. A
+// count is only waited for when none is known: the first cull, or a GPU a
+// whole ring behind.
+
+const int CULL_SLOTS = 3;
+
+struct GpuCuller {
+    bool useCompute = false;
+    Shader program;
+    GLuint instanceTexture = 0;   // samplerBuffer view of the caller's instance buffer
+    GLuint visibleBuffer = 0;     // compacted visible indices (feedback path: one range per slot)
+    GLuint commandBuffer = 0;     // compute path: DrawCommand with the visible count
+    GLuint feedbackQueries[CULL_SLOTS] = {};   // transform feedback path, one per slot
+    GLuint countBuffers[CULL_SLOTS] = {};      // compute path: copies of the count, one per slot
+    GLsync countFences[CULL_SLOTS] = {};
+    bool slotPending[CULL_SLOTS] = {};          // culled, count not read back yet
+    GLuint slotCount[CULL_SLOTS] = {};
+    int writeSlot = 0;            // range the next cull captures into
+    int drawSlot = -1;            // newest range with a known count; -1 before the first
+    GLuint instanceLocation = 0;  // the visible index attribute, re-pointed at drawSlot
+    float motionMargin = 0.0f;    // feedback path: world units an instance or the camera moves per frame (caller's)
+    glm::vec3 lastForward = glm::vec3(0.0f);   // previous cull's near plane normal, for the turn allowance
+    GLuint emptyVAO = 0;          // attribute-less point draw for the feedback path
+    GLsizei capacity = 0;
+    GLuint visibleCount = 0;      // feedback path: drawSlot's; compute path: the newest read back (stats only)
+    MeshRange mesh;
+};
+
+// The compute path needs GL 4.3 (compute + SSBO + indirect draws)
+static bool gpuCullingHasCompute() {
+    return GLEW_VERSION_4_3;
+}
+
+// instanceBuffer: capacity instances in whatever layout includePath reads,
+// viewed as texels of instanceFormat (RGBA32F, RGBA16F...)
+static void initGpuCuller(GpuCuller& culler, GLuint instanceBuffer, GLsizei capacity,
+                          const MeshRange& mesh, const char* includePath, bool useCompute,
+                          GLenum instanceFormat = GL_RGBA32F) {
+    culler.useCompute = useCompute;
+    culler.capacity = capacity;
+    culler.mesh = mesh;
+
+    if (useCompute) {
+        culler.program = Shader::compute("cull.comp", includePath);
+    } else {
+        culler.program = Shader::feedback("cull_feedback.vert", "cull_feedback.geom", includePath,
+                                          { "visibleIndex" });
+        glGenQueries(CULL_SLOTS, culler.feedbackQueries);
+        glGenVertexArrays(1, &culler.emptyVAO);
+    }
+
+    glGenTextures(1, &culler.instanceTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, culler.instanceTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, instanceFormat, instanceBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    GLsizeiptr visibleBytes = (GLsizeiptr)capacity * sizeof(GLuint) * (useCompute ? 1 : CULL_SLOTS);
+    glGenBuffers(1, &culler.visibleBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, culler.visibleBuffer);
+    glBufferData(GL_ARRAY_BUFFER, visibleBytes, nullptr, GL_DYNAMIC_COPY);
+    trackBuffer(culler.visibleBuffer, visibleBytes, "GpuCuller", "visible indices", "culling");
+
+    if (useCompute) {
+        DrawCommand cmd = { (GLuint)mesh.indexCount, 0, mesh.firstIndex, mesh.baseVertex, 0 };
+        glGenBuffers(1, &culler.commandBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, culler.commandBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(DrawCommand), &cmd, GL_DYNAMIC_DRAW);
+        trackBuffer(culler.commandBuffer, sizeof(DrawCommand), "GpuCuller", "indirect command", "culling");
+
+        glGenBuffers(CULL_SLOTS, culler.countBuffers);
+        for (GLuint buffer : culler.countBuffers) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+            trackBuffer(buffer, sizeof(GLuint), "GpuCuller", "visible count readback", "culling");
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Hooks the visible index list up as a per-instance uint attribute of vao
+static void bindCulledInstances(GpuCuller& culler, GLuint vao, GLuint location) {
+    culler.instanceLocation = location;
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, culler.visibleBuffer);
+    glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(location, 1);
+    glEnableVertexAttribArray(location);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Culls the first `count` instances. Uses texture unit `unit` for the instance
+// data; extra per-frame uniforms the include needs (time...) are set by the
+// caller on culler.program before this. Call invalidate() on any state cache
+// afterwards.
+static void runGpuCulling(GpuCuller& culler, const Frustum& frustum, GLsizei count, int unit) {
+    if (count > culler.capacity) count = culler.capacity;
+
+    glUseProgram(culler.program.ID);
+    for (int p = 0; p < 6; ++p)
+        culler.program.setVec4("frustumPlanes[" + std::to_string(p) + "]", frustum.planes[p]);
+    culler.program.setInt("instanceCount", count);
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, culler.instanceTexture);
+    culler.program.setInt("instanceData", unit);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (culler.useCompute) {
+        // reset the visible count, then append. A clear is queued on the GPU behind
+        // last frame's indirect draw; glBufferSubData would wait for that draw.
+        GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.commandBuffer);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, offsetof(DrawCommand, instanceCount), sizeof(GLuint),
+                             GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, culler.visibleBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, culler.commandBuffer);
+        glDispatchCompute((count + 63) / 64, 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        // the count for the stats: a copy per slot, read once its fence has signalled, never waited for
+        int slot = culler.writeSlot;
+        glBindBuffer(GL_COPY_READ_BUFFER, culler.commandBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, culler.countBuffers[slot]);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsetof(DrawCommand, instanceCount), 0,
+                            sizeof(GLuint));
+        if (culler.countFences[slot]) glDeleteSync(culler.countFences[slot]);
+        culler.countFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        culler.slotPending[slot] = true;
+        culler.writeSlot = (slot + 1) % CULL_SLOTS;
+
+        for (int age = 0; age < CULL_SLOTS; ++age) {
+            int s = (slot - age + CULL_SLOTS) % CULL_SLOTS;
+            if (!culler.slotPending[s]) continue;
+            GLenum status = glClientWaitSync(culler.countFences[s], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+            glBindBuffer(GL_COPY_READ_BUFFER, culler.countBuffers[s]);
+            glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(GLuint), &culler.visibleCount);
+            for (int older = age; older < CULL_SLOTS; ++older)   // anything older is stale now
+                culler.slotPending[(slot - older + CULL_SLOTS) % CULL_SLOTS] = false;
+            break;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return;
+    }
+
+    // the list drawn can be lag culls old; grow the spheres by what moves into view meanwhile
+    float lag = (float)(CULL_SLOTS - 1);
+    glm::vec3 forward(frustum.planes[4]);
+    float turn = glm::length(culler.lastForward) > 0.0f
+                     ? std::acos(glm::clamp(glm::dot(forward, culler.lastForward), -1.0f, 1.0f)) : 0.0f;
+    culler.lastForward = forward;
+    culler.program.setVec2("cullMargin", glm::vec2(culler.motionMargin * lag, std::tan(std::min(turn * lag, 0.5f))));
+
+    int slot = culler.writeSlot;
+    GLsizeiptr slotBytes = (GLsizeiptr)culler.capacity * sizeof(GLuint);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(culler.emptyVAO);
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, culler.visibleBuffer, slot * slotBytes, slotBytes);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, culler.feedbackQueries[slot]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, count);
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    culler.slotPending[slot] = true;
+    if (culler.drawSlot == slot) culler.drawSlot = -1;   // its old contents are being replaced
+    culler.writeSlot = (slot + 1) % CULL_SLOTS;
+
+    // newest first; a slot is either pending, known (drawSlot) or stale
+    for (int age = 0; age < CULL_SLOTS; ++age) {
+        int s = (slot - age + CULL_SLOTS) % CULL_SLOTS;
+        if (s == culler.drawSlot) break;   // nothing newer is ready
+        if (!culler.slotPending[s]) continue;
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(culler.feedbackQueries[s], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        glGetQueryObjectuiv(culler.feedbackQueries[s], GL_QUERY_RESULT, &culler.slotCount[s]);
+        culler.slotPending[s] = false;
+        culler.drawSlot = s;
+        break;
+    }
+    if (culler.drawSlot < 0) {
+        // first frame, or the GPU is a whole ring behind: wait, for the oldest pending one
+        for (int age = CULL_SLOTS - 1; age >= 0 && culler.drawSlot < 0; --age) {
+            int s = (slot - age + CULL_SLOTS) % CULL_SLOTS;
+            if (!culler.slotPending[s]) continue;
+            glGetQueryObjectuiv(culler.feedbackQueries[s], GL_QUERY_RESULT, &culler.slotCount[s]);
+            culler.slotPending[s] = false;
+            culler.drawSlot = s;
+        }
+    }
+    culler.visibleCount = culler.slotCount[culler.drawSlot];
+}
+
+// Draws the survivors of the last runGpuCulling with the caller's program and
+// a vao prepared with bindCulledInstances
+static void drawCulledInstances(const GpuCuller& culler, GLuint vao) {
+    glBindVertexArray(vao);
+    if (culler.useCompute) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culler.commandBuffer);
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0);
+    } else if (culler.visibleCount > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, culler.visibleBuffer);
+        glVertexAttribIPointer(culler.instanceLocation, 1, GL_UNSIGNED_INT, sizeof(GLuint),
+                               (void*)((size_t)culler.drawSlot * culler.capacity * sizeof(GLuint)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, culler.mesh.indexCount, GL_UNSIGNED_INT,
+                                          (void*)(culler.mesh.firstIndex * sizeof(GLuint)),
+                                          (GLsizei)culler.visibleCount, culler.mesh.baseVertex);
+    }
+}
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+#include <GLFW/glfw3.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// ------------------------------------------------------------
+// Input recording and deterministic replay
+// ------------------------------------------------------------
+// --record=file writes everything main's loop reads from the outside world:
+// the clock at each frame's processInput, the state of the keys it polls and
+// the mouse and scroll callbacks, in arrival order. --replay=file feeds the
+// same values back instead of asking GLFW, so the camera path, the time
+// boost, every toggle and the simulation time come out frame for frame the
+// same; only how long each frame takes is new. That's the point: replay a
+// reported stutter, or the same flight on two builds when bisecting.
+//
+// File: "SOLREC" + version byte + a zero byte, then tagged records, little
+// endian as written by the machine (x86 and ARM both are):
+//
+//     'F' double clock           a frame starts; seconds since glfwInit
+//     'K' uint16 keys            polled keys changed (INPUT_KEYS order, bit i)
+//     'M' float x, float y       cursor position callback
+//     'S' float y                scroll callback
+//
+// An hour at 60 fps with the mouse moving all the time is about 4 MB.
+// Replay runs with the recorded command-line options; window size and
+// --shading=compare's wall-clock switching aren't part of the recording.
+
+const char INPUT_MAGIC[8] = { 'S', 'O', 'L', 'R', 'E', 'C', 1, 0 };
+
+// the keys processInput polls; the bit in a 'K' record is the index here
+const int INPUT_KEYS[] = {
+    GLFW_KEY_ESCAPE, GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_3, GLFW_KEY_L,
+    GLFW_KEY_K, GLFW_KEY_P, GLFW_KEY_O, GLFW_KEY_T, GLFW_KEY_M, GLFW_KEY_F3,
+};
+const int INPUT_KEY_COUNT = sizeof(INPUT_KEYS) / sizeof(INPUT_KEYS[0]);
+
+enum class InputMode { Live, Record, Replay };
+
+struct InputRecorder {
+    InputMode mode = InputMode::Live;
+    std::string path;
+    std::ofstream out;
+    std::vector<unsigned char> data;   // the whole recording, when replaying
+    size_t cursor = 0;
+    uint16_t keys = 0;                 // this frame's key bits (recorded or replayed)
+    bool recordedKeys = false;         // a 'K' was written at least once
+    double clock = 0.0;                // this frame's clock
+    bool finished = false;             // replay ran out of frames
+
+    // replay summary: wall time per replayed frame, to find the stutter again
+    unsigned long frames = 0;
+    std::chrono::steady_clock::time_point start, lastFrame;
+    double worstMs = 0.0, worstClock = 0.0;
+    unsigned long worstFrame = 0;
+};
+
+static void writeInputRecord(InputRecorder& input, char tag, const void* payload, size_t bytes) {
+    input.out.put(tag);
+    input.out.write((const char*)payload, (std::streamsize)bytes);
+}
+
+// Record or replay per the options; false (and Live) if the file can't be used
+static bool initInputRecorder(InputRecorder& input, const std::string& recordPath, const std::string& replayPath) {
+    if (!replayPath.empty()) {
+        std::ifstream in(replayPath, std::ios::binary);
+        input.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (input.data.size() < sizeof(INPUT_MAGIC) || std::memcmp(input.data.data(), INPUT_MAGIC, sizeof(INPUT_MAGIC))) {
+            std::cerr << "replay: " << replayPath << " isn't a recording" << std::endl;
+            return false;
+        }
+        input.cursor = sizeof(INPUT_MAGIC);
+        input.mode = InputMode::Replay;
+        input.path = replayPath;
+        input.start = input.lastFrame = std::chrono::steady_clock::now();
+        std::cout << "replay: " << replayPath << ", " << input.data.size() << " bytes" << std::endl;
+    } else if (!recordPath.empty()) {
+        input.out.open(recordPath, std::ios::binary);
+        if (!input.out) {
+            std::cerr << "record: can't write " << recordPath << std::endl;
+            return false;
+        }
+        input.out.write(INPUT_MAGIC, sizeof(INPUT_MAGIC));
+        input.mode = InputMode::Record;
+        input.path = recordPath;
+    }
+    return true;
+}
+
+// From the GLFW callbacks: true when the event should move the camera (not
+// while replaying; the recording's own events do that)
+static bool inputCursorEvent(InputRecorder& input, double x, double y) {
+    if (input.mode == InputMode::Replay) return false;
+    if (input.mode == InputMode::Record) {
+        float xy[2] = { (float)x, (float)y };
+        writeInputRecord(input, 'M', xy, sizeof(xy));
+    }
+    return true;
+}
+
+static bool inputScrollEvent(InputRecorder& input, double y) {
+    if (input.mode == InputMode::Replay) return false;
+    if (input.mode == InputMode::Record) {
+        float v = (float)y;
+        writeInputRecord(input, 'S', &v, sizeof(v));
+    }
+    return true;
+}
+
+// Called at the top of processInput: this frame's clock and key state, and
+// when replaying the recorded cursor and scroll events before it, through
+// the callbacks' handlers. Returns the clock; check input.finished after it.
+static double beginInputFrame(InputRecorder& input, GLFWwindow* window, void (*onCursor)(double, double),
+                              void (*onScroll)(double)) {
+    if (input.mode != InputMode::Replay) {
+        uint16_t keys = 0;
+        for (int i = 0; i < INPUT_KEY_COUNT; ++i)
+            if (glfwGetKey(window, INPUT_KEYS[i]) == GLFW_PRESS) keys |= (uint16_t)(1u << i);
+        input.clock = glfwGetTime();
+        if (input.mode == InputMode::Record) {
+            if (keys != input.keys || !input.recordedKeys) writeInputRecord(input, 'K', &keys, sizeof(keys));
+            writeInputRecord(input, 'F', &input.clock, sizeof(input.clock));
+            input.recordedKeys = true;
+        }
+        input.keys = keys;
+        return input.clock;
+    }
+
+    // wall time of the frame that just ended
+    auto now = std::chrono::steady_clock::now();
+    if (input.frames > 0) {
+        double ms = std::chrono::duration<double, std::milli>(now - input.lastFrame).count();
+        if (ms > input.worstMs) {
+            input.worstMs = ms;
+            input.worstFrame = input.frames - 1;
+            input.worstClock = input.clock;
+        }
+    }
+    input.lastFrame = now;
+
+    const std::vector<unsigned char>& d = input.data;
+    while (input.cursor < d.size()) {
+        char tag = (char)d[input.cursor++];
+        size_t bytes = tag == 'F' ? sizeof(double) : tag == 'K' ? sizeof(uint16_t) : tag == 'M' ? 2 * sizeof(float)
+                     : tag == 'S' ? sizeof(float) : 0;
+        if (bytes == 0 || input.cursor + bytes > d.size()) {
+            std::cerr << "replay: bad record at byte " << input.cursor - 1 << std::endl;
+            break;
+        }
+        const unsigned char* p = &d[input.cursor];
+        input.cursor += bytes;
+        if (tag == 'F') {
+            std::memcpy(&input.clock, p, sizeof(double));
+            input.frames++;
+            return input.clock;
+        } else if (tag == 'K') {
+            std::memcpy(&input.keys, p, sizeof(uint16_t));
+        } else if (tag == 'M') {
+            float xy[2];
+            std::memcpy(xy, p, sizeof(xy));
+            onCursor(xy[0], xy[1]);
+        } else {
+            float y;
+            std::memcpy(&y, p, sizeof(y));
+            onScroll(y);
+        }
+    }
+    input.finished = true;
+    return input.clock;
+}
+
+// Key state for this frame: recorded when replaying (Escape still quits live)
+static bool inputKeyDown(const InputRecorder& input, GLFWwindow* window, int key) {
+    if (input.mode == InputMode::Replay && key == GLFW_KEY_ESCAPE && glfwGetKey(window, key) == GLFW_PRESS)
+        return true;
+    for (int i = 0; i < INPUT_KEY_COUNT; ++i)
+        if (INPUT_KEYS[i] == key) return (input.keys >> i) & 1u;
+    return glfwGetKey(window, key) == GLFW_PRESS;
+}
+
+static void finishInputRecorder(InputRecorder& input) {
+    if (input.mode == InputMode::Record) {
+        input.out.close();
+        std::cout << "record: input written to " << input.path << std::endl;
+    } else if (input.mode == InputMode::Replay && input.frames > 0) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - input.start).count();
+        std::ios::fmtflags flags = std::cout.flags();
+        std::streamsize precision = std::cout.precision();
+        std::cout << std::fixed << std::setprecision(2) << "replay: " << input.frames << " frames in " << seconds
+                  << " s (avg " << seconds * 1000.0 / input.frames << " ms), slowest frame " << input.worstFrame
+                  << " at clock " << input.worstClock << " s: " << input.worstMs << " ms" << std::endl;
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// One shared vertex/index arena for all static geometry
+// ------------------------------------------------------------
+// Every mesh (sphere, ring, probe...) is appended into the same VBO/EBO and
+// drawn through a single VAO, so a whole pass can be one indirect call.
+// Vertex layout is the usual interleaved pos(3) | uv(2) | normal(3);
+// attribute 3 carries the per-draw index (see DrawList.h).
+
+struct MeshRange {
+    int id = -1;              // index in the arena, used for sort keys
+    GLuint firstIndex = 0;
+    GLsizei indexCount = 0;
+    GLint baseVertex = 0;
+    float radius = 1.0f;      // bounding sphere radius around the mesh origin
+};
+
+struct MeshArena {
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    GLuint drawIDBuffer = 0;          // 0, 1, 2, ... read with divisor 1 (multi-draw path only)
+    GLsizei maxDraws = 0;
+    std::vector<float> vertices;      // staged until uploadMeshArena
+    std::vector<GLuint> indices;
+    std::vector<MeshRange> meshes;
+};
+
+static MeshRange addArenaMesh(MeshArena& arena, const std::vector<float>& vertices,
+                              const std::vector<unsigned int>& indices) {
+    MeshRange range;
+    range.id = (int)arena.meshes.size();
+    range.firstIndex = (GLuint)arena.indices.size();
+    range.indexCount = (GLsizei)indices.size();
+    range.baseVertex = (GLint)(arena.vertices.size() / 8);
+
+    range.radius = 0.0f;
+    for (size_t v = 0; v + 2 < vertices.size(); v += 8)
+        range.radius = std::max(range.radius, glm::length(glm::vec3(vertices[v], vertices[v + 1], vertices[v + 2])));
+
+    arena.vertices.insert(arena.vertices.end(), vertices.begin(), vertices.end());
+    arena.indices.insert(arena.indices.end(), indices.begin(), indices.end());
+    arena.meshes.push_back(range);
+    return range;
+}
+
+// Another VAO over the arena's buffers with pos/uv/normal set up (for
+// instanced draws that bring their own per-instance attributes).
+// Leaves the new VAO bound.
+static GLuint createArenaVAO(const MeshArena& arena) {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.EBO);
+
+    // pos(0), uv(1), normal(2) with stride 8 floats
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    return vao;
+}
+
+// Uploads everything staged so far. With maxDraws > 0 attribute 3 reads the
+// draw index from an instanced buffer (baseInstance selects the draw);
+// otherwise it is left disabled and set per draw with glVertexAttribI1ui.
+static void uploadMeshArena(MeshArena& arena, GLsizei maxDraws) {
+    glGenBuffers(1, &arena.VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.VBO);
+    glBufferData(GL_ARRAY_BUFFER, arena.vertices.size() * sizeof(float), arena.vertices.data(), GL_STATIC_DRAW);
+    trackBuffer(arena.VBO, arena.vertices.size() * sizeof(float), "MeshArena", "vertices", "mesh");
+
+    // indices go up through the array target: the element binding belongs to whatever VAO is bound
+    glGenBuffers(1, &arena.EBO);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.EBO);
+    glBufferData(GL_ARRAY_BUFFER, arena.indices.size() * sizeof(GLuint), arena.indices.data(), GL_STATIC_DRAW);
+    trackBuffer(arena.EBO, arena.indices.size() * sizeof(GLuint), "MeshArena", "indices", "mesh");
+
+    arena.VAO = createArenaVAO(arena);
+
+    // draw index (3)
+    arena.maxDraws = maxDraws;
+    if (maxDraws > 0) {
+        std::vector<GLuint> ids(maxDraws);
+        for (GLsizei i = 0; i < maxDraws; ++i) ids[i] = (GLuint)i;
+        glGenBuffers(1, &arena.drawIDBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, arena.drawIDBuffer);
+        glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(GLuint), ids.data(), GL_STATIC_DRAW);
+        trackBuffer(arena.drawIDBuffer, ids.size() * sizeof(GLuint), "MeshArena", "draw IDs", "mesh");
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(3);
+    }
+
+    glBindVertexArray(0);
+
+    // the GPU copy is all we need from here on
+    arena.vertices.clear();
+    arena.vertices.shrink_to_fit();
+    arena.indices.clear();
+    arena.indices.shrink_to_fit();
+}
+
+#endif
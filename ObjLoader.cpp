@@ -1,4 +1,5 @@
 #include "ObjLoader.h"
+#include "StartupTimer.h"
 #include <glm/glm.hpp>
 #include <fstream>
 #include <sstream>
@@ -31,11 +32,17 @@ static inline int toIndex(const std::string& token, int count) {
     return (v > 0) ? (v - 1) : (count + v);
 }
 
-MeshData loadOBJ(const std::string& path) {
+bool parseOBJ(const std::string& path, std::vector<float>& interleaved,
+              std::vector<GLuint>& indices, float& radius) {
+    StartupScope trace("parseOBJ", "load", path.c_str());
+    interleaved.clear();
+    indices.clear();
+    radius = 0.0f;
+
     std::ifstream file(path);
     if (!file.is_open()) {
         std::cerr << "Failed to open OBJ file: " << path << std::endl;
-        return {0,0,0,0};
+        return false;
     }
 
     std::vector<glm::vec3> positions;
@@ -44,7 +51,6 @@ MeshData loadOBJ(const std::string& path) {
 
     std::vector<Vertex>              vertices;       // unique vertex buffer
     std::map<Vertex, GLuint>         vertexToIndex;  // vertex -> index
-    std::vector<GLuint>              indices;        // triangle indices
 
     std::string line, tag;
     while (std::getline(file, line)) {
@@ -110,9 +116,9 @@ MeshData loadOBJ(const std::string& path) {
     }
 
     // Interleave: pos(3) | uv(2) | normal(3)
-    std::vector<float> interleaved;
     interleaved.reserve(vertices.size() * 8);
     for (const auto& v : vertices) {
+        radius = std::max(radius, glm::length(v.position));
         interleaved.push_back(v.position.x);
         interleaved.push_back(v.position.y);
         interleaved.push_back(v.position.z);
@@ -122,30 +128,5 @@ MeshData loadOBJ(const std::string& path) {
         interleaved.push_back(v.normal.y);
         interleaved.push_back(v.normal.z);
     }
-
-    GLuint VAO=0, VBO=0, EBO=0;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(interleaved.size()*sizeof(float)), interleaved.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size()*sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0); // position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8*sizeof(float), (void*)0);
-
-    glEnableVertexAttribArray(1); // uv
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8*sizeof(float), (void*)(3*sizeof(float)));
-
-    glEnableVertexAttribArray(2); // normal
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8*sizeof(float), (void*)(5*sizeof(float)));
-
-    glBindVertexArray(0);
-
-    return { VAO, VBO, EBO, (GLsizei)indices.size() };
+    return true;
 }
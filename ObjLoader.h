@@ -1,12 +1,8 @@
 #pragma once
 #include <GL/glew.h>
 #include <string>
+#include <vector>
 
-struct MeshData {
-    GLuint VAO;
-    GLuint VBO;
-    GLuint EBO;
-    GLsizei indexCount;
-};
-
-MeshData loadOBJ(const std::string& path);
+// CPU side only: interleaved pos(3) | uv(2) | normal(3) plus triangle indices
+bool parseOBJ(const std::string& path, std::vector<float>& interleaved,
+              std::vector<GLuint>& indices, float& radius);
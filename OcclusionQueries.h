@@ -0,0 +1,78 @@
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+#include <vector>
+#include <algorithm>
+
+// ------------------------------------------------------------
+// Per-object occlusion queries for conditional rendering
+// ------------------------------------------------------------
+// Each frame every candidate's bounding proxy is drawn (no color, no depth
+// writes) against the finished depth buffer inside an ANY_SAMPLES_PASSED
+// query. Next frame the real draw is wrapped in
+// glBeginConditionalRender(query, GL_QUERY_NO_WAIT): the GPU skips it if the
+// proxy was hidden, and simply draws it if the result isn't in yet, so the
+// CPU never waits. Two query sets alternate so the set being issued is never
+// the one the draws are conditioned on.
+//
+// A hidden object becomes visible one frame late at worst; proxies are
+// slightly inflated to keep that from showing at silhouettes.
+
+struct OcclusionQueries {
+    std::vector<GLuint> queries[2];
+    std::vector<char> issued[2];
+    int current = 0;                  // set being issued this frame
+    unsigned long tested = 0, hidden = 0;   // collected results (non-blocking), for reports
+};
+
+static void initOcclusionQueries(OcclusionQueries& oq, int count) {
+    for (int s = 0; s < 2; ++s) {
+        oq.queries[s].resize(count);
+        oq.issued[s].assign(count, 0);
+        glGenQueries(count, oq.queries[s].data());
+    }
+}
+
+// Query the draw of object i should be conditioned on, or 0 for "just draw it"
+static GLuint occlusionCondition(const OcclusionQueries& oq, int i) {
+    int prev = oq.current ^ 1;
+    return oq.issued[prev][i] ? oq.queries[prev][i] : 0;
+}
+
+static void beginOcclusionQuery(OcclusionQueries& oq, int i) {
+    // this slot was last issued two frames ago; count its result if it's ready
+    if (oq.issued[oq.current][i]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(oq.queries[oq.current][i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint anyPassed = 1;
+            glGetQueryObjectuiv(oq.queries[oq.current][i], GL_QUERY_RESULT, &anyPassed);
+            oq.tested++;
+            if (!anyPassed) oq.hidden++;
+        }
+    }
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, oq.queries[oq.current][i]);
+    oq.issued[oq.current][i] = 1;
+}
+
+static void endOcclusionQuery(OcclusionQueries&) {
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+}
+
+// Objects that got no query this frame (camera inside the proxy...) are drawn
+// unconditionally next frame
+static void skipOcclusionQuery(OcclusionQueries& oq, int i) {
+    oq.issued[oq.current][i] = 0;
+}
+
+// forget every query (e.g. while occlusion culling is switched off)
+static void resetOcclusionQueries(OcclusionQueries& oq) {
+    for (int s = 0; s < 2; ++s) std::fill(oq.issued[s].begin(), oq.issued[s].end(), 0);
+}
+
+// call once per frame after all queries were issued
+static void swapOcclusionQueries(OcclusionQueries& oq) {
+    oq.current ^= 1;
+}
+
+#endif
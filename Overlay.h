@@ -0,0 +1,185 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <vector>
+#include <string>
+#include <cctype>
+#include "Shader.h"
+#include "DrawList.h" // GLStateCache
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// Text overlay drawn over the finished frame in one draw
+// ------------------------------------------------------------
+// A 5x7 bitmap font (upper case, digits, a little punctuation) is built into
+// one R8 atlas at init, each glyph in a 6x8 cell. Every character on screen
+// is an instance (column, row, glyph, colour) in a small vertex buffer;
+// overlay.vert makes its cell's quad from gl_VertexID and overlay.frag looks
+// the glyph up with texelFetch, so the whole overlay is one
+// glDrawArraysInstanced of a few hundred tiny quads. The text only goes to
+// the GPU when it changed (setOverlayLine...), not every frame.
+
+// glyph i of OVERLAY_GLYPHS is OVERLAY_FONT[i]: 7 rows of 5, top row first
+static const char OVERLAY_GLYPHS[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:/%-()=,+";
+static const char* OVERLAY_FONT[] = {
+    "..... ..... ..... ..... ..... ..... .....",   // space
+    ".###. #...# #..## #.#.# ##..# #...# .###.",   // 0
+    "..#.. .##.. ..#.. ..#.. ..#.. ..#.. .###.",
+    ".###. #...# ....# ...#. ..#.. .#... #####",
+    "####. ....# ....# .###. ....# ....# ####.",
+    "...#. ..##. .#.#. #..#. ##### ...#. ...#.",
+    "##### #.... ####. ....# ....# #...# .###.",
+    "..##. .#... #.... ####. #...# #...# .###.",
+    "##### ....# ...#. ..#.. .#... .#... .#...",
+    ".###. #...# #...# .###. #...# #...# .###.",
+    ".###. #...# #...# .#### ....# ...#. .##..",   // 9
+    ".###. #...# #...# ##### #...# #...# #...#",   // A
+    "####. #...# #...# ####. #...# #...# ####.",
+    ".###. #...# #.... #.... #.... #...# .###.",
+    "###.. #..#. #...# #...# #...# #..#. ###..",
+    "##### #.... #.... ####. #.... #.... #####",
+    "##### #.... #.... ####. #.... #.... #....",
+    ".###. #...# #.... #.### #...# #...# .####",
+    "#...# #...# #...# ##### #...# #...# #...#",
+    ".###. ..#.. ..#.. ..#.. ..#.. ..#.. .###.",
+    "..### ...#. ...#. ...#. ...#. #..#. .##..",
+    "#...# #..#. #.#.. ##... #.#.. #..#. #...#",
+    "#.... #.... #.... #.... #.... #.... #####",
+    "#...# ##.## #.#.# #.#.# #...# #...# #...#",
+    "#...# #...# ##..# #.#.# #..## #...# #...#",
+    ".###. #...# #...# #...# #...# #...# .###.",
+    "####. #...# #...# ####. #.... #.... #....",
+    ".###. #...# #...# #...# #.#.# #..#. .##.#",
+    "####. #...# #...# ####. #.#.. #..#. #...#",
+    ".#### #.... #.... .###. ....# ....# ####.",
+    "##### ..#.. ..#.. ..#.. ..#.. ..#.. ..#..",
+    "#...# #...# #...# #...# #...# #...# .###.",
+    "#...# #...# #...# #...# #...# .#.#. ..#..",
+    "#...# #...# #...# #.#.# #.#.# #.#.# .#.#.",
+    "#...# #...# .#.#. ..#.. .#.#. #...# #...#",
+    "#...# #...# .#.#. ..#.. ..#.. ..#.. ..#..",
+    "##### ....# ...#. ..#.. .#... #.... #####",   // Z
+    "..... ..... ..... ..... ..... .##.. .##..",   // .
+    "..... .##.. .##.. ..... .##.. .##.. .....",   // :
+    "....# ....# ...#. ..#.. .#... #.... #....",   // /
+    "##..# ##..# ...#. ..#.. .#... #..## #..##",   // %
+    "..... ..... ..... ##### ..... ..... .....",   // -
+    "...#. ..#.. .#... .#... .#... ..#.. ...#.",   // (
+    ".#... ..#.. ...#. ...#. ...#. ..#.. .#...",   // )
+    "..... ..... ##### ..... ##### ..... .....",   // =
+    "..... ..... ..... ..... .##.. ..#.. .#...",   // ,
+    "..... ..#.. ..#.. ##### ..#.. ..#.. .....",   // +
+};
+const int OVERLAY_GLYPH_COUNT = sizeof(OVERLAY_GLYPHS) - 1;
+
+struct OverlayChar {              // attribute 0 of overlay.vert, one per instance
+    GLushort column, row, glyph, colour;
+};
+
+struct Overlay {
+    GLuint atlas = 0, VAO = 0, VBO = 0;
+    Shader shader;
+    std::vector<std::string> lines;
+    std::vector<int> lineColours;     // 0 = normal, 1 = warning
+    std::vector<OverlayChar> chars;
+    GLsizeiptr capacity = 0;          // VBO bytes
+    GLsizei instances = 0;            // characters in the VBO
+    bool dirty = false;
+    float pixelScale = 2.0f;          // screen pixels per font texel
+};
+
+static void initOverlay(Overlay& overlay, int unit) {
+    const int atlasWidth = OVERLAY_GLYPH_COUNT * 6, atlasHeight = 8;
+    std::vector<unsigned char> texels(atlasWidth * atlasHeight, 0);
+    for (int g = 0; g < OVERLAY_GLYPH_COUNT; ++g) {
+        const char* bits = OVERLAY_FONT[g];
+        for (int row = 0; row < 7; ++row)
+            for (int col = 0; col < 5; ++col)
+                if (bits[row * 6 + col] == '#') texels[row * atlasWidth + g * 6 + col] = 255;
+    }
+    glGenTextures(1, &overlay.atlas);
+    glBindTexture(GL_TEXTURE_2D, overlay.atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);   // rows aren't a multiple of 4 bytes
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    trackTexture(overlay.atlas, textureBytes(GL_R8, atlasWidth, atlasHeight, 1, false), "Overlay", "font atlas", "overlay");
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenVertexArrays(1, &overlay.VAO);
+    glGenBuffers(1, &overlay.VBO);
+    glBindVertexArray(overlay.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, overlay.VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 4, GL_UNSIGNED_SHORT, sizeof(OverlayChar), (void*)0);
+    glVertexAttribDivisor(0, 1);
+    glBindVertexArray(0);
+
+    overlay.shader = Shader("overlay.vert", "overlay.frag");
+    overlay.shader.use();
+    overlay.shader.setInt("fontAtlas", unit);
+}
+
+// Replaces line `row` (growing the list as needed); only marks the overlay
+// dirty when the text actually changed
+static void setOverlayLine(Overlay& overlay, int row, const std::string& text, int colour = 0) {
+    if ((int)overlay.lines.size() <= row) {
+        overlay.lines.resize(row + 1);
+        overlay.lineColours.resize(row + 1, 0);
+    }
+    if (overlay.lines[row] == text && overlay.lineColours[row] == colour) return;
+    overlay.lines[row] = text;
+    overlay.lineColours[row] = colour;
+    overlay.dirty = true;
+}
+
+static int overlayGlyph(char c) {
+    c = (char)std::toupper((unsigned char)c);
+    for (int g = 0; g < OVERLAY_GLYPH_COUNT; ++g)
+        if (OVERLAY_GLYPHS[g] == c) return g;
+    return 0;   // anything else draws as a blank cell
+}
+
+// Into the currently bound framebuffer (the window, after post-processing);
+// the atlas goes on the unit given to initOverlay
+static void drawOverlay(Overlay& overlay, GLStateCache& cache, int unit, int width, int height) {
+    if (overlay.dirty) {
+        overlay.chars.clear();
+        for (size_t row = 0; row < overlay.lines.size(); ++row)
+            for (size_t col = 0; col < overlay.lines[row].size(); ++col)
+                overlay.chars.push_back({ (GLushort)col, (GLushort)row,
+                                          (GLushort)overlayGlyph(overlay.lines[row][col]),
+                                          (GLushort)overlay.lineColours[row] });
+        GLsizeiptr bytes = (GLsizeiptr)(overlay.chars.size() * sizeof(OverlayChar));
+        glBindBuffer(GL_ARRAY_BUFFER, overlay.VBO);
+        if (bytes > overlay.capacity) {
+            overlay.capacity = bytes * 2;
+            trackBuffer(overlay.VBO, overlay.capacity, "Overlay", "characters", "overlay");
+        }
+        glBufferData(GL_ARRAY_BUFFER, overlay.capacity, nullptr, GL_STREAM_DRAW);   // orphan
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, overlay.chars.data());
+        overlay.instances = (GLsizei)overlay.chars.size();
+        overlay.dirty = false;
+    }
+    if (overlay.instances == 0) return;
+
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.useProgram(overlay.shader.ID);
+    overlay.shader.setVec2("screenSize", glm::vec2((float)width, (float)height));
+    overlay.shader.setFloat("pixelScale", overlay.pixelScale);
+    cache.bindTexture(unit, GL_TEXTURE_2D, overlay.atlas);
+    cache.bindVertexArray(overlay.VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, overlay.instances);
+    cache.stats.glCalls++;
+    cache.stats.submits++;
+    cache.stats.draws++;
+    cache.stats.triangles += 2 * overlay.instances;
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+#endif
@@ -3,16 +3,22 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <random>
 #include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include "Shader.h"
-
-// Simple mesh container for generated planets/rings
-struct Planet {
-    unsigned int VAO = 0, VBO = 0, EBO = 0, textureID = 0;
-    std::vector<float> vertices;         // interleaved: pos(3), uv(2), normal(3)  => 8 floats per vertex
-    std::vector<unsigned int> indices;
+#include "MeshArena.h"
+
+// Where a body sits this frame; the depth and main passes both build draws from these
+struct SceneBody {
+    MeshRange mesh;                  // range in the shared MeshArena
+    int layer = 0;                   // albedo array layer
+    glm::vec3 position = glm::vec3(0.0f);
+    float scale = 1.0f;
+    float spin = 0.0f;
+    float tilt = 0.0f;
+    bool castsShadow = true;
 };
 
 // -------------------------------
@@ -82,186 +88,186 @@ static void generateSphereMesh(
 }
 
 // ----------------------------------------
-// Ring (plane) mesh for Saturn-like rings
+// Ring (annulus) mesh for Saturn-like rings
 // ----------------------------------------
-// Simple quad grid in XY plane (Z = 0), normal = +Z.
+// Flat annulus in the XY plane (Z = 0), normal = +Z, between innerRadius and
+// outerRadius of the [-1,1] square. UVs are planar (same as the old square
+// plane), so saturnRings_texture.png maps unchanged; its alpha is non-zero
+// between r ~0.55 and 1.0, which is what the defaults cover. About half the
+// square's area, i.e. half the fragments.
 // Interleaved vertices: [x,y,0, u,v, 0,0,1]
-static void generatePlaneMesh(
+static void generateRingMesh(
     std::vector<float>& vertices,
     std::vector<unsigned int>& indices,
-    int widthSegments  = 32,
-    int heightSegments = 32
+    float innerRadius = 0.54f,
+    float outerRadius = 1.0f,
+    int segments      = 128
 ) {
     vertices.clear();
     indices.clear();
+    const float PI = 3.14159265359f;
 
-    // Build [0,1] UV-mapped plane spanning [-1,1] in X and Y
-    for (int i = 0; i <= heightSegments; ++i) {
-        float v  = (float)i / heightSegments;
-        float y  = -1.f + 2.f * v;
-
-        for (int j = 0; j <= widthSegments; ++j) {
-            float u = (float)j / widthSegments;
-            float x = -1.f + 2.f * u;
-
-            // position
+    // inner/outer vertex pair per angle step; the seam repeats the first pair
+    for (int j = 0; j <= segments; ++j) {
+        float a = 2.0f * PI * (float)j / segments;
+        float c = std::cos(a), s = std::sin(a);
+        for (float r : { innerRadius, outerRadius }) {
+            float x = r * c, y = r * s;
             vertices.push_back(x);
             vertices.push_back(y);
             vertices.push_back(0.f);
-            // uv
-            vertices.push_back(u);
-            vertices.push_back(v);
-            // normal +Z
+            vertices.push_back(x * 0.5f + 0.5f);
+            vertices.push_back(y * 0.5f + 0.5f);
             vertices.push_back(0.f);
             vertices.push_back(0.f);
             vertices.push_back(1.f);
         }
     }
 
-    for (int i = 0; i < heightSegments; ++i) {
-        for (int j = 0; j < widthSegments; ++j) {
-            int topLeft     = i * (widthSegments + 1) + j;
-            int topRight    = topLeft + 1;
-            int bottomLeft  = (i + 1) * (widthSegments + 1) + j;
-            int bottomRight = bottomLeft + 1;
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
+    for (int j = 0; j < segments; ++j) {
+        unsigned int in0 = 2 * j, out0 = in0 + 1, in1 = in0 + 2, out1 = in0 + 3;
+        indices.push_back(in0);
+        indices.push_back(out0);
+        indices.push_back(in1);
 
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
-        }
+        indices.push_back(in1);
+        indices.push_back(out0);
+        indices.push_back(out1);
     }
 }
 
-// -------------------------------
-// Texture loader helper (declared elsewhere in your project)
-// -------------------------------
-extern unsigned int loadTexture(const char* path);
-
-// -------------------------------------------
-// Initialization for planets (sphere geometry)
-// -------------------------------------------
-static void initPlanet(Planet& planet, const std::string& texturePath) {
-    generateSphereMesh(planet.vertices, planet.indices);
-
-    glGenVertexArrays(1, &planet.VAO);
-    glGenBuffers(1, &planet.VBO);
-    glGenBuffers(1, &planet.EBO);
-
-    glBindVertexArray(planet.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, planet.VBO);
-    glBufferData(GL_ARRAY_BUFFER,
-                 planet.vertices.size() * sizeof(float),
-                 planet.vertices.data(),
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, planet.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 planet.indices.size() * sizeof(unsigned int),
-                 planet.indices.data(),
-                 GL_STATIC_DRAW);
-
-    // pos(0), uv(1), normal(2) with stride 8 floats
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+// ----------------------------------------
+// Box mesh (occlusion query proxies)
+// ----------------------------------------
+// Cube spanning [-1,1] on every axis, same interleaved layout as the others
+// (uv and normals are unused placeholders). Circumscribes the unit sphere.
+static void generateBoxMesh(
+    std::vector<float>& vertices,
+    std::vector<unsigned int>& indices
+) {
+    vertices.clear();
+    indices.clear();
 
-    // Texture
-    planet.textureID = loadTexture(texturePath.c_str());
+    for (int c = 0; c < 8; ++c) {
+        float x = (c & 1) ? 1.f : -1.f;
+        float y = (c & 2) ? 1.f : -1.f;
+        float z = (c & 4) ? 1.f : -1.f;
+        float corner[8] = { x, y, z, 0.f, 0.f, x, y, z };
+        vertices.insert(vertices.end(), corner, corner + 8);
+    }
 
-    glBindVertexArray(0);
+    static const unsigned int faces[36] = {
+        0, 2, 1,  1, 2, 3,   // -z
+        4, 5, 6,  5, 7, 6,   // +z
+        0, 1, 4,  1, 5, 4,   // -y
+        2, 6, 3,  3, 6, 7,   // +y
+        0, 4, 2,  2, 4, 6,   // -x
+        1, 3, 5,  3, 7, 5,   // +x
+    };
+    indices.assign(faces, faces + 36);
 }
 
-// -------------------------------------------
-// Initialization for rings (plane geometry)
-// -------------------------------------------
-static void initRings(Planet& rings, const std::string& texturePath) {
-    generatePlaneMesh(rings.vertices, rings.indices);
-
-    glGenVertexArrays(1, &rings.VAO);
-    glGenBuffers(1, &rings.VBO);
-    glGenBuffers(1, &rings.EBO);
-
-    glBindVertexArray(rings.VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, rings.VBO);
-    glBufferData(GL_ARRAY_BUFFER,
-                 rings.vertices.size() * sizeof(float),
-                 rings.vertices.data(),
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rings.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 rings.indices.size() * sizeof(unsigned int),
-                 rings.indices.data(),
-                 GL_STATIC_DRAW);
-
-    // pos(0), uv(1), normal(2) with stride 8 floats
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+// ----------------------------------------
+// Low-poly rock (asteroid belt instances)
+// ----------------------------------------
+// Icosahedron subdivided `subdivisions` times (20 * 4^n triangles: 80 by
+// default, against Asteroid.obj's 13,824) with every vertex pushed in or out
+// by up to `roughness`. Belt asteroids are a few pixels across, where this
+// looks the same as the full mesh at a fraction of the vertex work.
+// Z up like the sphere, spherical UVs, normals averaged over the faces.
+static void generateRockMesh(
+    std::vector<float>& vertices,
+    std::vector<unsigned int>& indices,
+    int subdivisions = 1,
+    float roughness  = 0.25f,
+    unsigned int seed = 7
+) {
+    vertices.clear();
+    indices.clear();
+    const float PI = 3.14159265359f;
 
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    std::vector<glm::vec3> points = {
+        { -1,  t,  0 }, {  1,  t,  0 }, { -1, -t,  0 }, {  1, -t,  0 },
+        {  0, -1,  t }, {  0,  1,  t }, {  0, -1, -t }, {  0,  1, -t },
+        {  t,  0, -1 }, {  t,  0,  1 }, { -t,  0, -1 }, { -t,  0,  1 },
+    };
+    for (glm::vec3& p : points) p = glm::normalize(p);
+    std::vector<unsigned int> faces = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1,
+    };
+
+    // split every triangle in four; shared edges share their midpoint
+    for (int s = 0; s < subdivisions; ++s) {
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+        auto midpoint = [&](unsigned int a, unsigned int b) {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto found = midpoints.find(key);
+            if (found != midpoints.end()) return found->second;
+            points.push_back(glm::normalize(points[a] + points[b]));
+            return midpoints[key] = (unsigned int)points.size() - 1;
+        };
+        std::vector<unsigned int> split;
+        split.reserve(faces.size() * 4);
+        for (size_t f = 0; f < faces.size(); f += 3) {
+            unsigned int a = faces[f], b = faces[f + 1], c = faces[f + 2];
+            unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            unsigned int tris[12] = { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca };
+            split.insert(split.end(), tris, tris + 12);
+        }
+        faces.swap(split);
+    }
 
-    // Texture (rings texture may be PNG with alpha; your loader handles formats)
-    rings.textureID = loadTexture(texturePath.c_str());
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> bump(1.0f - roughness, 1.0f + roughness);
+    std::vector<glm::vec3> normals(points.size(), glm::vec3(0.0f));
+    for (glm::vec3& p : points) p *= bump(rng);
+    for (size_t f = 0; f < faces.size(); f += 3) {
+        glm::vec3 a = points[faces[f]], b = points[faces[f + 1]], c = points[faces[f + 2]];
+        glm::vec3 n = glm::cross(b - a, c - a);   // area weighted
+        for (int k = 0; k < 3; ++k) normals[faces[f + k]] += n;
+    }
 
-    glBindVertexArray(0);
+    for (size_t v = 0; v < points.size(); ++v) {
+        glm::vec3 p = points[v], n = glm::normalize(normals[v]), d = glm::normalize(p);
+        float vertex[8] = { p.x, p.y, p.z,
+                            std::atan2(d.y, d.x) / (2.0f * PI) + 0.5f, std::asin(d.z) / PI + 0.5f,
+                            n.x, n.y, n.z };
+        vertices.insert(vertices.end(), vertex, vertex + 8);
+    }
+    indices.assign(faces.begin(), faces.end());
 }
 
 // -------------------------------------------
-// Render helpers
+// Model matrices
 // -------------------------------------------
-static void renderPlanet(Planet& planet, Shader& shader,
-                         glm::vec3 position,
-                         float scale = 1.0f,
-                         float spin = 0.0f,
-                         float tilt = 0.0f) {
+static glm::mat4 planetModelMatrix(glm::vec3 position,
+                                   float scale = 1.0f,
+                                   float spin = 0.0f,
+                                   float tilt = 0.0f) {
     glm::mat4 model(1.0f);
     model = glm::translate(model, position);
     model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // fix orientation
     model = glm::rotate(model, glm::radians(tilt),    glm::vec3(0.0f, 0.0f, 1.0f)); // axial tilt
     model = glm::rotate(model, glm::radians(spin),    glm::vec3(0.0f, 0.0f, 1.0f)); // spin
     model = glm::scale(model, glm::vec3(scale));
-
-    shader.setMat4("model", model);
-
-    glBindTexture(GL_TEXTURE_2D, planet.textureID);
-    glBindVertexArray(planet.VAO);
-    glDrawElements(GL_TRIANGLES, (GLsizei)planet.indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    return model;
 }
 
-static void renderRings(Planet& rings, Shader& shader,
-                        glm::vec3 position,
-                        float scale = 1.0f,
-                        float spin = 0.0f,
-                        float tilt = 0.0f) {
+static glm::mat4 ringModelMatrix(glm::vec3 position,
+                                 float scale = 1.0f,
+                                 float spin = 0.0f,
+                                 float tilt = 0.0f) {
     glm::mat4 model(1.0f);
     model = glm::translate(model, position);
     // rings lie in XY; tilt/spin around Z
     model = glm::rotate(model, glm::radians(tilt), glm::vec3(0.0f, 0.0f, 1.0f));
     model = glm::rotate(model, glm::radians(spin), glm::vec3(0.0f, 0.0f, 1.0f));
     model = glm::scale(model, glm::vec3(scale));
-
-    shader.setMat4("model", model);
-
-    glBindTexture(GL_TEXTURE_2D, rings.textureID);
-    glBindVertexArray(rings.VAO);
-    glDrawElements(GL_TRIANGLES, (GLsizei)rings.indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    return model;
 }
 
 #endif
@@ -0,0 +1,168 @@
+#ifndef POINT_SHADOW_H
+#define POINT_SHADOW_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Shader.h"
+#include "Frustum.h"
+#include "ShadowCascades.h" // ShadowSphere
+
+// ------------------------------------------------------------
+// Omnidirectional (cube map) shadows for a point light
+// ------------------------------------------------------------
+// Each face stores linear distance to the light / farPlane. Faces are
+// refreshed lazily: only when the set of casters seen by a face changes or
+// they have moved relative to the light by more than a texel-sized
+// threshold, and never more than maxFacesPerFrame faces per frame.
+
+struct PointShadowFace {
+    bool needsRender = false;
+    std::vector<int> casters;              // indices into the sphere list
+    std::vector<glm::vec3> casterOffsets;  // caster centre - light position at render time
+};
+
+struct PointShadowMap {
+    GLuint FBO = 0, depthCube = 0;
+    unsigned int size = 512;
+    float nearPlane = 0.05f;
+    float farPlane  = 20.0f;           // fragments further than this from the light are never shadowed
+    int maxFacesPerFrame = 1;          // 0 = unlimited
+    float cacheThreshold = 1.0f;       // texels of relative caster motion before a face is stale
+    int roundRobin = 0;
+    glm::vec3 lightPos = glm::vec3(0.0f);
+    glm::mat4 faceMatrices[6];
+    PointShadowFace faces[6];
+    unsigned long facesRendered = 0, facesSkipped = 0;
+};
+
+static void initPointShadowMap(PointShadowMap& psm, unsigned int size = 512, float farPlane = 20.0f) {
+    psm.size = size;
+    psm.farPlane = farPlane;
+
+    glGenTextures(1, &psm.depthCube);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, psm.depthCube);
+    for (int f = 0; f < 6; ++f) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_DEPTH_COMPONENT24,
+                     psm.size, psm.size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    }
+    trackTexture(psm.depthCube, textureBytes(GL_DEPTH_COMPONENT24, psm.size, psm.size, 6, false),
+                 "PointShadowMap", "cube", "shadow");
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &psm.FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, psm.FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X, psm.depthCube, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    // start with every face cleared to "nothing in range" so faces can be filled in over several frames
+    for (int f = 0; f < 6; ++f) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, psm.depthCube, 0);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// -------------------------------------------
+// Per-frame: face matrices, caster lists, and which faces to refresh
+// -------------------------------------------
+// ignore is a sphere index that must never cast (the body the light sits in).
+static void updatePointShadow(PointShadowMap& psm, const glm::vec3& lightPos,
+                              const std::vector<ShadowSphere>& spheres, int ignore) {
+    static const glm::vec3 dirs[6] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+    };
+    static const glm::vec3 ups[6] = {
+        { 0, -1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, -1, 0 }, { 0, -1, 0 }
+    };
+
+    psm.lightPos = lightPos;
+    glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, psm.nearPlane, psm.farPlane);
+
+    std::vector<int> changed, stale;   // caster set changed / casters drifted
+    std::vector<int> casters[6];
+    for (int f = 0; f < 6; ++f) {
+        PointShadowFace& face = psm.faces[f];
+        face.needsRender = false;
+        psm.faceMatrices[f] = proj * glm::lookAt(lightPos, lightPos + dirs[f], ups[f]);
+
+        Frustum frustum = extractFrustum(psm.faceMatrices[f]);
+        for (int i = 0; i < (int)spheres.size(); ++i) {
+            const ShadowSphere& s = spheres[i];
+            if (!s.caster || i == ignore) continue;
+            if (sphereInFrustum(frustum, s.center, s.radius)) casters[f].push_back(i);
+        }
+
+        // new or departed casters: the face must be redrawn (or cleared) before it can be trusted
+        if (casters[f] != face.casters) {
+            changed.push_back(f);
+            continue;
+        }
+
+        // relative caster motion against the texel footprint at that distance
+        for (size_t k = 0; k < face.casters.size(); ++k) {
+            glm::vec3 offset = spheres[face.casters[k]].center - lightPos;
+            float texel = 2.0f * glm::length(offset) / (float)psm.size;
+            if (glm::length(offset - face.casterOffsets[k]) > psm.cacheThreshold * texel) {
+                stale.push_back(f);
+                break;
+            }
+        }
+    }
+
+    // faces whose caster set changed go first, then drifted faces round-robin
+    int budget = psm.maxFacesPerFrame > 0 ? psm.maxFacesPerFrame : 6;
+    for (int f : changed) {
+        if (budget == 0) break;
+        psm.faces[f].needsRender = true;
+        budget--;
+    }
+    for (int n = 0; n < 6 && budget > 0 && !stale.empty(); ++n) {
+        int f = (psm.roundRobin + n) % 6;
+        if (std::find(stale.begin(), stale.end(), f) == stale.end()) continue;
+        psm.faces[f].needsRender = true;
+        psm.roundRobin = (f + 1) % 6;
+        budget--;
+    }
+
+    for (int f = 0; f < 6; ++f) {
+        PointShadowFace& face = psm.faces[f];
+        if (!face.needsRender) continue;
+        face.casters = casters[f];
+        face.casterOffsets.clear();
+        for (int i : face.casters) face.casterOffsets.push_back(spheres[i].center - lightPos);
+    }
+}
+
+// Binds the face as depth target. Returns false when the cached face is kept.
+static bool beginPointShadowFace(PointShadowMap& psm, int f, Shader& pointShader) {
+    PointShadowFace& face = psm.faces[f];
+    if (!face.needsRender) {
+        psm.facesSkipped++;
+        return false;
+    }
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, psm.depthCube, 0);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    pointShader.setMat4("lightSpaceMatrix", psm.faceMatrices[f]);
+
+    face.needsRender = false;
+    psm.facesRendered++;
+    return true;
+}
+
+static void bindPointShadow(const PointShadowMap& psm, Shader& shader, int unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, psm.depthCube);
+    shader.setInt("earthShadowMap", unit);
+    shader.setFloat("earthShadowFar", psm.farPlane);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+#endif
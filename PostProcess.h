@@ -0,0 +1,227 @@
+#ifndef POST_PROCESS_H
+#define POST_PROCESS_H
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <glm/glm.hpp>
+#include "Shader.h"
+#include "DrawList.h" // GLStateCache
+#include "Profiler.h"
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// HDR scene target and the post-processing chain
+// ------------------------------------------------------------
+// Surfaces write linear RGBA16F (fragment.glsl / deferred_light.frag); this
+// turns it into the window image with fullscreen passes, each a GPU profiler zone:
+//
+//   bloom     bright-pass + downsample to 1/2 ... 1/32, then tent upsample back
+//             to 1/2, adding each level onto the next (never at full res)
+//   exposure  weighted log luminance at 256x256, mipmapped down to 1x1 (the
+//             pyramid), then a 1x1 pass eases the adapted value towards it.
+//             Nothing is read back; the tonemap samples the 1x1 texture.
+//   tonemap   scene + bloom, exposure, Reinhard, gamma, into the window
+//
+// The forward path draws into sceneFBO here; the deferred path has its own
+// lit target (DeferredShading.h) and passes that instead.
+
+const int BLOOM_LEVELS = 5;
+const int LUMINANCE_SIZE = 256;
+
+struct PostProcess {
+    int width = 0, height = 0;
+    GLuint sceneColor = 0, sceneDepth = 0, sceneFBO = 0;   // forward path HDR target
+
+    GLuint bloom[BLOOM_LEVELS] = {};
+    GLuint bloomFBO[BLOOM_LEVELS] = {};
+    int bloomWidth[BLOOM_LEVELS] = {}, bloomHeight[BLOOM_LEVELS] = {};
+
+    GLuint luminance = 0, luminanceFBO = 0;   // RG16F pyramid
+    GLuint adapted[2] = {}, adaptedFBO[2] = {};
+    int adaptedCurrent = 0;
+
+    GLuint emptyVAO = 0;
+    Shader downsample, upsample, luminancePass, adapt, tonemap;
+
+    float bloomThreshold = 1.0f;   // linear colour above which things glow
+    float bloomStrength = 0.08f;
+    float exposureKey = 0.8f;      // adapted average luminance maps to this
+    float adaptRate = 1.5f;        // per second
+};
+
+static GLuint createPostTexture(GLenum internalFormat, GLenum format, int width, int height, GLenum filter,
+                                const std::string& name) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, nullptr);
+    bool mips = filter != GL_LINEAR && filter != GL_NEAREST;   // the caller generates the chain
+    trackTexture(tex, textureBytes(internalFormat, width, height, 1, mips), "PostProcess", name, "post");
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+static GLuint createPostFBO(GLuint color, GLuint depth = 0) {
+    GLuint fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    if (depth) glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "PostProcess: framebuffer incomplete" << std::endl;
+    return fbo;
+}
+
+// Size-independent parts: programs, the exposure pyramid, the adapted luminance
+static void initPostProcess(PostProcess& post) {
+    post.downsample    = Shader("fullscreen.vert", "post_downsample.frag");
+    post.upsample      = Shader("fullscreen.vert", "post_upsample.frag");
+    post.luminancePass = Shader("fullscreen.vert", "post_luminance.frag");
+    post.adapt         = Shader("fullscreen.vert", "post_adapt.frag");
+    post.tonemap       = Shader("fullscreen.vert", "post_tonemap.frag");
+    glGenVertexArrays(1, &post.emptyVAO);
+
+    post.luminance = createPostTexture(GL_RG16F, GL_RG, LUMINANCE_SIZE, LUMINANCE_SIZE, GL_LINEAR_MIPMAP_LINEAR,
+                                       "luminance");
+    glGenerateMipmap(GL_TEXTURE_2D);   // allocate the pyramid
+    post.luminanceFBO = createPostFBO(post.luminance);
+
+    const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 2; ++i) {
+        post.adapted[i] = createPostTexture(GL_R16F, GL_RED, 1, 1, GL_NEAREST, "adapted");
+        post.adaptedFBO[i] = createPostFBO(post.adapted[i]);
+        glClearBufferfv(GL_COLOR, 0, zero);   // 0 = snap to the first measurement
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// (Re)creates the screen-sized targets when the framebuffer size changes
+static void resizePostProcess(PostProcess& post, int width, int height) {
+    if (post.width == width && post.height == height) return;
+    if (post.sceneFBO) {
+        GLuint textures[2] = { post.sceneColor, post.sceneDepth };
+        glDeleteTextures(2, textures);
+        glDeleteTextures(BLOOM_LEVELS, post.bloom);
+        for (GLuint t : textures) untrackTexture(t);
+        for (GLuint t : post.bloom) untrackTexture(t);
+        glDeleteFramebuffers(1, &post.sceneFBO);
+        glDeleteFramebuffers(BLOOM_LEVELS, post.bloomFBO);
+    }
+    post.width = width;
+    post.height = height;
+
+    post.sceneColor = createPostTexture(GL_RGBA16F, GL_RGBA, width, height, GL_LINEAR, "scene colour");
+    post.sceneDepth = createPostTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, width, height, GL_NEAREST,
+                                        "scene depth");
+    post.sceneFBO = createPostFBO(post.sceneColor, post.sceneDepth);
+
+    for (int i = 0; i < BLOOM_LEVELS; ++i) {
+        post.bloomWidth[i] = std::max(width >> (i + 1), 1);
+        post.bloomHeight[i] = std::max(height >> (i + 1), 1);
+        post.bloom[i] = createPostTexture(GL_RGBA16F, GL_RGBA, post.bloomWidth[i], post.bloomHeight[i], GL_LINEAR,
+                                          "bloom " + std::to_string(i));
+        post.bloomFBO[i] = createPostFBO(post.bloom[i]);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Forward path: the main pass draws into the HDR target after this
+static void beginHdrScene(const PostProcess& post) {
+    glBindFramebuffer(GL_FRAMEBUFFER, post.sceneFBO);
+    glViewport(0, 0, post.width, post.height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+static void drawPostTriangle(const PostProcess& post, GLStateCache& cache) {
+    cache.bindVertexArray(post.emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    cache.stats.glCalls++;
+    cache.stats.submits++;
+    cache.stats.draws++;
+    cache.stats.triangles++;
+}
+
+// hdrScene (linear RGBA16F, the size given to resizePostProcess) -> window.
+// Sampler units firstUnit..firstUnit+2. No GPU zone may be open around it.
+static void runPostProcess(PostProcess& post, GLuint hdrScene, float deltaTime,
+                           GLStateCache& cache, int firstUnit, Profiler& profiler) {
+    glDisable(GL_DEPTH_TEST);
+
+    // ---- bloom ----
+    GpuZone bloomZone(profiler, "post: bloom");
+    cache.useProgram(post.downsample.ID);
+    post.downsample.setInt("source", firstUnit);
+    post.downsample.setFloat("threshold", post.bloomThreshold);
+    for (int i = 0; i < BLOOM_LEVELS; ++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, post.bloomFBO[i]);
+        glViewport(0, 0, post.bloomWidth[i], post.bloomHeight[i]);
+        cache.bindTexture(firstUnit, GL_TEXTURE_2D, i == 0 ? hdrScene : post.bloom[i - 1]);
+        post.downsample.setBool("prefilter", i == 0);
+        post.downsample.setVec2("targetSize", glm::vec2(post.bloomWidth[i], post.bloomHeight[i]));
+        drawPostTriangle(post, cache);
+    }
+    cache.useProgram(post.upsample.ID);
+    post.upsample.setInt("source", firstUnit);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    for (int i = BLOOM_LEVELS - 2; i >= 0; --i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, post.bloomFBO[i]);
+        glViewport(0, 0, post.bloomWidth[i], post.bloomHeight[i]);
+        cache.bindTexture(firstUnit, GL_TEXTURE_2D, post.bloom[i + 1]);
+        post.upsample.setVec2("targetSize", glm::vec2(post.bloomWidth[i], post.bloomHeight[i]));
+        drawPostTriangle(post, cache);
+    }
+    glDisable(GL_BLEND);
+    bloomZone.end();
+
+    // ---- exposure ----
+    GpuZone exposureZone(profiler, "post: exposure");
+    glBindFramebuffer(GL_FRAMEBUFFER, post.luminanceFBO);
+    glViewport(0, 0, LUMINANCE_SIZE, LUMINANCE_SIZE);
+    cache.useProgram(post.luminancePass.ID);
+    post.luminancePass.setInt("scene", firstUnit);
+    cache.bindTexture(firstUnit, GL_TEXTURE_2D, hdrScene);
+    drawPostTriangle(post, cache);
+    cache.bindTexture(firstUnit, GL_TEXTURE_2D, post.luminance);
+    glGenerateMipmap(GL_TEXTURE_2D);   // the pyramid: 256 -> 1
+    cache.stats.glCalls++;
+
+    int next = post.adaptedCurrent ^ 1;
+    glBindFramebuffer(GL_FRAMEBUFFER, post.adaptedFBO[next]);
+    glViewport(0, 0, 1, 1);
+    cache.useProgram(post.adapt.ID);
+    cache.bindTexture(firstUnit + 1, GL_TEXTURE_2D, post.adapted[post.adaptedCurrent]);
+    post.adapt.setInt("luminance", firstUnit);
+    post.adapt.setInt("previous", firstUnit + 1);
+    post.adapt.setFloat("topLevel", std::log2((float)LUMINANCE_SIZE));
+    post.adapt.setFloat("adaptAmount", 1.0f - std::exp(-deltaTime * post.adaptRate));
+    drawPostTriangle(post, cache);
+    post.adaptedCurrent = next;
+    exposureZone.end();
+
+    // ---- tonemap ----
+    GpuZone tonemapZone(profiler, "post: tonemap");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, post.width, post.height);
+    cache.useProgram(post.tonemap.ID);
+    cache.bindTexture(firstUnit,     GL_TEXTURE_2D, hdrScene);
+    cache.bindTexture(firstUnit + 1, GL_TEXTURE_2D, post.bloom[0]);
+    cache.bindTexture(firstUnit + 2, GL_TEXTURE_2D, post.adapted[post.adaptedCurrent]);
+    post.tonemap.setInt("scene", firstUnit);
+    post.tonemap.setInt("bloom", firstUnit + 1);
+    post.tonemap.setInt("adaptedLuminance", firstUnit + 2);
+    post.tonemap.setFloat("bloomStrength", post.bloomStrength);
+    post.tonemap.setFloat("exposureKey", post.exposureKey);
+    drawPostTriangle(post, cache);
+    tonemapZone.end();
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+#endif
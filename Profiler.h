@@ -0,0 +1,187 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include "Trace.h"
+
+// ------------------------------------------------------------
+// Frame profiler: named CPU and GPU zones with rolling statistics
+// ------------------------------------------------------------
+//     { CpuZone zone(profiler, "input"); processInput(window); }
+//     GpuZone gpu(profiler, "main pass");   // ... gpu.end() or leave the scope
+//
+// CPU zones time with steady_clock. GPU zones wrap GL_TIME_ELAPSED queries,
+// two per zone used on alternate frames; a result is picked up when its slot
+// comes round again and only if the GPU has it ready, so the profiler never
+// stalls the pipeline (a frame's GPU number just shows up a frame later).
+// TIME_ELAPSED can't nest, so GPU zones must not overlap; CPU zones can.
+//
+// Every zone keeps its last PROFILER_HISTORY samples; profileStats() gives
+// min / avg / p99 over them. Zones are found by name, created on first use
+// and reported in that order. CPU zones also go into the trace (Trace.h)
+// when it is on, so `name` must be a string literal.
+
+const int PROFILER_HISTORY = 240;   // ~4 s at 60 fps
+
+struct ProfileZone {
+    std::string name;
+    bool gpu = false;
+    std::vector<float> history;     // ms, ring buffer
+    int next = 0;
+    std::chrono::steady_clock::time_point start;
+    GLuint queries[2] = { 0, 0 };
+    bool pending[2] = { false, false };
+    int current = 0;
+};
+
+struct ProfileStats {
+    float min = 0.0f, avg = 0.0f, p99 = 0.0f;
+    int samples = 0;
+};
+
+struct Profiler {
+    std::vector<ProfileZone> zones;
+    int openGpuZone = -1;
+};
+
+static int profilerZone(Profiler& profiler, const char* name, bool gpu) {
+    for (int i = 0; i < (int)profiler.zones.size(); ++i)
+        if (profiler.zones[i].gpu == gpu && profiler.zones[i].name == name) return i;
+    ProfileZone zone;
+    zone.name = name;
+    zone.gpu = gpu;
+    zone.history.reserve(PROFILER_HISTORY);
+    if (gpu) glGenQueries(2, zone.queries);
+    profiler.zones.push_back(zone);
+    return (int)profiler.zones.size() - 1;
+}
+
+static void recordProfileSample(ProfileZone& zone, float ms) {
+    if ((int)zone.history.size() < PROFILER_HISTORY) zone.history.push_back(ms);
+    else zone.history[zone.next] = ms;
+    zone.next = (zone.next + 1) % PROFILER_HISTORY;
+}
+
+static void beginGpuZone(Profiler& profiler, int z) {
+    if (profiler.openGpuZone >= 0) {
+        std::cerr << "Profiler: GPU zone '" << profiler.zones[z].name << "' inside '"
+                  << profiler.zones[profiler.openGpuZone].name << "' (GPU zones can't nest)" << std::endl;
+        return;
+    }
+    ProfileZone& zone = profiler.zones[z];
+    int q = zone.current;
+    if (zone.pending[q]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(zone.queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(zone.queries[q], GL_QUERY_RESULT, &ns);
+            recordProfileSample(zone, (float)(ns * 1e-6));
+        }
+        zone.pending[q] = false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, zone.queries[q]);
+    profiler.openGpuZone = z;
+}
+
+static void endGpuZone(Profiler& profiler, int z) {
+    if (profiler.openGpuZone != z) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    ProfileZone& zone = profiler.zones[z];
+    zone.pending[zone.current] = true;
+    zone.current ^= 1;
+    profiler.openGpuZone = -1;
+}
+
+// RAII zones; end() closes one early (e.g. when the section isn't its own scope)
+struct CpuZone {
+    Profiler& profiler;
+    int zone;
+    bool open = true;
+    TraceScope trace;
+    CpuZone(Profiler& p, const char* name)
+        : profiler(p), zone(profilerZone(p, name, false)), trace(name, "frame") {
+        profiler.zones[zone].start = std::chrono::steady_clock::now();
+    }
+    void end() {
+        if (!open) return;
+        open = false;
+        std::chrono::duration<float, std::milli> ms = std::chrono::steady_clock::now() - profiler.zones[zone].start;
+        recordProfileSample(profiler.zones[zone], ms.count());
+        trace.end();
+    }
+    ~CpuZone() { end(); }
+};
+
+struct GpuZone {
+    Profiler& profiler;
+    int zone;
+    bool open = true;
+    GpuZone(Profiler& p, const char* name) : profiler(p), zone(profilerZone(p, name, true)) {
+        beginGpuZone(profiler, zone);
+    }
+    void end() {
+        if (!open) return;
+        open = false;
+        endGpuZone(profiler, zone);
+    }
+    ~GpuZone() { end(); }
+};
+
+static ProfileStats profileStats(const ProfileZone& zone) {
+    ProfileStats st;
+    st.samples = (int)zone.history.size();
+    if (st.samples == 0) return st;
+    std::vector<float> sorted = zone.history;
+    std::sort(sorted.begin(), sorted.end());
+    float sum = 0.0f;
+    for (float ms : sorted) sum += ms;
+    st.min = sorted.front();
+    st.avg = sum / st.samples;
+    st.p99 = sorted[std::min(st.samples - 1, (int)(st.samples * 0.99f))];
+    return st;
+}
+
+// Mean over the history only; cheap enough to call every frame
+static float profileAverage(const ProfileZone& zone) {
+    if (zone.history.empty()) return 0.0f;
+    float sum = 0.0f;
+    for (float ms : zone.history) sum += ms;
+    return sum / zone.history.size();
+}
+
+// Stats of a zone by name; all zero if it never ran
+static ProfileStats profileStats(const Profiler& profiler, const char* name, bool gpu) {
+    for (const ProfileZone& zone : profiler.zones)
+        if (zone.gpu == gpu && zone.name == name) return profileStats(zone);
+    return ProfileStats();
+}
+
+// drop every zone's history (e.g. when switching render paths)
+static void resetProfiler(Profiler& profiler) {
+    for (ProfileZone& zone : profiler.zones) {
+        zone.history.clear();
+        zone.next = 0;
+    }
+}
+
+static void printProfile(const Profiler& profiler, std::ostream& out) {
+    out << "profile (ms over the last " << PROFILER_HISTORY << " frames)     min      avg      p99" << std::endl;
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    for (const ProfileZone& zone : profiler.zones) {
+        ProfileStats st = profileStats(zone);
+        out << "  " << (zone.gpu ? "gpu " : "cpu ") << std::left << std::setw(34) << zone.name << std::right
+            << std::setw(9) << st.min << std::setw(9) << st.avg << std::setw(9) << st.p99 << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+#endif
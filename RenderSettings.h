@@ -0,0 +1,102 @@
+#ifndef RENDER_SETTINGS_H
+#define RENDER_SETTINGS_H
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+// -------------------------------
+// Startup options (command line)
+// -------------------------------
+// ./main --shadows=analytic --asteroids=200000 --lights=1000
+
+enum class ShadowMode {
+    Maps,       // cascaded sun shadow maps + earth light cube map
+    Analytic    // ray-sphere eclipse tests in the fragment shader, no depth passes
+};
+
+enum class CullPath {
+    Auto,       // compute when the context has GL 4.3, else transform feedback
+    Compute,
+    Feedback    // force the GL 3.3 path (e.g. to compare on the same machine)
+};
+
+enum class ShadingPath {
+    Forward,    // fragment.glsl shades every rasterized fragment
+    Deferred    // G-buffer + one fullscreen lighting pass (DeferredShading.h)
+};
+
+struct RenderSettings {
+    ShadowMode shadowMode = ShadowMode::Maps;
+    int asteroidCount = 50000;   // belt instances (80 triangles each); 0 = no belt
+    CullPath cullPath = CullPath::Auto;
+    bool depthPrepass = false;   // also toggled with P at runtime
+    bool occlusionCulling = true; // O at runtime
+    int lightCount = 256;        // clustered point lights; 0 = only the sun and earthLight
+    ShadingPath shading = ShadingPath::Forward;
+    bool compareShading = false; // benchmark scene, alternating forward/deferred every report
+    std::string tracePath;       // Chrome trace JSON (Trace.h); empty = no tracing
+    bool overlay = true;         // stats overlay (Overlay.h), F3 at runtime
+    std::string statsPath;       // counters as JSON every statsInterval s (FrameStats.h); empty = off
+    float statsInterval = 1.0f;
+    std::string glBudget;        // per-frame GL limits, checked in SOLAR_GL_DEBUG builds (GLDebug.h)
+    std::string recordPath;      // input + clock of every frame (InputRecorder.h); empty = off
+    std::string replayPath;      // drive the loop from such a recording instead of live input
+    float startupBudget = 0.0f;  // ms from launch to the first frame (StartupTimer.h); 0 = no limit
+};
+
+static RenderSettings parseRenderSettings(int argc, char** argv) {
+    RenderSettings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shadows=maps") {
+            settings.shadowMode = ShadowMode::Maps;
+        } else if (arg == "--shadows=analytic") {
+            settings.shadowMode = ShadowMode::Analytic;
+        } else if (arg == "--depth-prepass") {
+            settings.depthPrepass = true;
+        } else if (arg == "--no-occlusion") {
+            settings.occlusionCulling = false;
+        } else if (arg.rfind("--asteroids=", 0) == 0) {
+            settings.asteroidCount = std::max(0, std::atoi(arg.c_str() + 12));
+        } else if (arg.rfind("--lights=", 0) == 0) {
+            settings.lightCount = std::max(0, std::atoi(arg.c_str() + 9));
+        } else if (arg == "--shading=forward") {
+            settings.shading = ShadingPath::Forward;
+        } else if (arg == "--shading=deferred") {
+            settings.shading = ShadingPath::Deferred;
+        } else if (arg == "--shading=compare") {
+            settings.compareShading = true;
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            settings.tracePath = arg.substr(8);
+        } else if (arg == "--trace") {
+            settings.tracePath = "trace.json";
+        } else if (arg == "--no-overlay") {
+            settings.overlay = false;
+        } else if (arg.rfind("--stats-file=", 0) == 0) {
+            settings.statsPath = arg.substr(13);
+        } else if (arg.rfind("--stats-interval=", 0) == 0) {
+            settings.statsInterval = std::max(0.05f, (float)std::atof(arg.c_str() + 17));
+        } else if (arg.rfind("--gl-budget=", 0) == 0) {
+            settings.glBudget = arg.substr(12);
+        } else if (arg.rfind("--record=", 0) == 0) {
+            settings.recordPath = arg.substr(9);
+        } else if (arg.rfind("--replay=", 0) == 0) {
+            settings.replayPath = arg.substr(9);
+        } else if (arg.rfind("--startup-budget=", 0) == 0) {
+            settings.startupBudget = std::max(0.0f, (float)std::atof(arg.c_str() + 17));
+        } else if (arg == "--culling=auto") {
+            settings.cullPath = CullPath::Auto;
+        } else if (arg == "--culling=compute") {
+            settings.cullPath = CullPath::Compute;
+        } else if (arg == "--culling=feedback") {
+            settings.cullPath = CullPath::Feedback;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+        }
+    }
+    return settings;
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef RESOURCE_TRACKER_H
+#define RESOURCE_TRACKER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+
+// ------------------------------------------------------------
+// Memory accounting: GL buffers and textures, long-lived CPU copies
+// ------------------------------------------------------------
+// Whatever allocates storage says so, with an owner (the struct or function
+// that holds it), a name and a category:
+//
+//     trackBuffer(arena.VBO, bytes, "MeshArena", "vertices", "mesh");
+//     trackTexture(id, textureBytes(GL_RGBA8, w, h, 1, true), "loadTexture", path, "staging");
+//     untrackTexture(id);   // next to the glDeleteTextures
+//
+// Tracking an id again replaces its entry, labels and all (orphaning,
+// resizes, a GL name reused after a delete or in a new context). CPU copies
+// that outlive start-up (staging, per-frame lists) are keyed by their
+// owner's address and re-tracked when they grow. Sizes are texels x texel
+// size (+ the mip chain), what the driver has to hold at least; its own
+// padding isn't visible through GL. Buffer textures are views and count
+// under the buffer. printResourceReport() gives totals by kind and
+// category and the biggest entries.
+//
+// The list is shared by every translation unit (inline, like Trace.h), so
+// ObjLoader.cpp's uploads land in the same report. Whoever destroys a GL
+// context calls resetTrackedResources(): its names die with it.
+
+enum class ResourceKind { Buffer, Texture, Cpu };
+
+struct TrackedResource {
+    ResourceKind kind = ResourceKind::Buffer;
+    std::uintptr_t key = 0;       // GL name, or the owner's address for CPU copies
+    std::string owner, name, category;
+    unsigned long long bytes = 0;
+};
+
+struct ResourceTotals {
+    unsigned long long buffers = 0, textures = 0, cpu = 0;
+};
+
+inline std::vector<TrackedResource>& trackedResources() {
+    static std::vector<TrackedResource> resources;
+    return resources;
+}
+
+inline void trackResource(ResourceKind kind, std::uintptr_t key, unsigned long long bytes,
+                          const char* owner, const std::string& name, const char* category) {
+    if (!key) return;
+    TrackedResource r;
+    r.kind = kind;
+    r.key = key;
+    r.owner = owner;
+    r.name = name;
+    r.category = category;
+    r.bytes = bytes;
+    std::vector<TrackedResource>& list = trackedResources();
+    for (TrackedResource& existing : list) {
+        if (existing.kind == kind && existing.key == key) {
+            existing = r;
+            return;
+        }
+    }
+    list.push_back(r);
+}
+
+inline void untrackResource(ResourceKind kind, std::uintptr_t key) {
+    std::vector<TrackedResource>& list = trackedResources();
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [&](const TrackedResource& r) { return r.kind == kind && r.key == key; }),
+               list.end());
+}
+
+inline void trackBuffer(GLuint buffer, unsigned long long bytes, const char* owner, const std::string& name,
+                        const char* category) {
+    trackResource(ResourceKind::Buffer, buffer, bytes, owner, name, category);
+}
+
+inline void trackTexture(GLuint texture, unsigned long long bytes, const char* owner, const std::string& name,
+                         const char* category) {
+    trackResource(ResourceKind::Texture, texture, bytes, owner, name, category);
+}
+
+inline void trackCpu(const void* holder, unsigned long long bytes, const char* owner, const std::string& name,
+                     const char* category) {
+    trackResource(ResourceKind::Cpu, (std::uintptr_t)holder, bytes, owner, name, category);
+}
+
+// new size for an entry that is already tracked (orphaning a buffer at a new size)
+inline void resizeTrackedBuffer(GLuint buffer, unsigned long long bytes) {
+    for (TrackedResource& r : trackedResources())
+        if (r.kind == ResourceKind::Buffer && r.key == buffer) r.bytes = bytes;
+}
+
+inline void untrackBuffer(GLuint buffer) { untrackResource(ResourceKind::Buffer, buffer); }
+inline void untrackTexture(GLuint texture) { untrackResource(ResourceKind::Texture, texture); }
+
+// Forgets everything, e.g. when the context holding it all is destroyed
+inline void resetTrackedResources() {
+    trackedResources().clear();
+}
+
+// Bytes per texel of the sized formats used here (unsized RGB/RGBA as the
+// driver stores them, RGB padded to 4); DEPTH24 lives in 32 bits
+inline unsigned int texelBytes(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_R8:                  return 1;
+    case GL_R16F:                return 2;
+    case GL_RG16F:               return 4;
+    case GL_RGBA16F:
+    case GL_RGBA16UI:            return 8;
+    case GL_RGBA32F:             return 16;
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT:
+    case GL_RGB:
+    case GL_RGBA:
+    case GL_RGBA8:
+    default:                     return 4;
+    }
+}
+
+// width x height x layers, plus every level down to 1x1 when mipmapped
+inline unsigned long long textureBytes(GLenum internalFormat, int width, int height, int layers, bool mips) {
+    unsigned long long texels = 0;
+    for (int w = width, h = height;; w = std::max(w / 2, 1), h = std::max(h / 2, 1)) {
+        texels += (unsigned long long)w * h;
+        if (!mips || (w == 1 && h == 1)) break;
+    }
+    return texels * layers * texelBytes(internalFormat);
+}
+
+inline ResourceTotals resourceTotals() {
+    ResourceTotals totals;
+    for (const TrackedResource& r : trackedResources()) {
+        if (r.kind == ResourceKind::Buffer) totals.buffers += r.bytes;
+        else if (r.kind == ResourceKind::Texture) totals.textures += r.bytes;
+        else totals.cpu += r.bytes;
+    }
+    return totals;
+}
+
+inline double megabytes(unsigned long long bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+inline void printResourceReport(std::ostream& out, size_t top = 12) {
+    const std::vector<TrackedResource>& list = trackedResources();
+    ResourceTotals totals = resourceTotals();
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << "memory: GPU " << megabytes(totals.buffers + totals.textures) << " MB (textures "
+        << megabytes(totals.textures) << " MB, buffers " << megabytes(totals.buffers) << " MB), CPU copies "
+        << megabytes(totals.cpu) << " MB in " << list.size() << " allocations" << std::endl;
+
+    std::map<std::string, unsigned long long> categories;
+    for (const TrackedResource& r : list) categories[r.category] += r.bytes;
+    std::vector<std::pair<unsigned long long, std::string>> byCategory;
+    for (const auto& c : categories) byCategory.push_back({ c.second, c.first });
+    std::sort(byCategory.rbegin(), byCategory.rend());
+    out << "  by category:";
+    for (const auto& c : byCategory) out << " " << c.second << " " << megabytes(c.first) << " MB,";
+    out << std::endl;
+
+    std::vector<const TrackedResource*> sorted;
+    for (const TrackedResource& r : list) sorted.push_back(&r);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const TrackedResource* a, const TrackedResource* b) { return a->bytes > b->bytes; });
+    out << "  top consumers:" << std::endl;
+    for (size_t i = 0; i < sorted.size() && i < top; ++i) {
+        const TrackedResource& r = *sorted[i];
+        const char* kind = r.kind == ResourceKind::Buffer ? "buffer " : r.kind == ResourceKind::Texture ? "texture" : "cpu    ";
+        out << "    " << std::setw(9) << megabytes(r.bytes) << " MB  " << kind << "  " << r.owner << " " << r.name
+            << " (" << r.category << ")" << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+#endif
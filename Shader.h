@@ -2,59 +2,63 @@
 #define SHADER_H
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include "StartupTimer.h"
 
 class Shader {
 public:
-    unsigned int ID;
-    Shader(const char* vertexPath, const char* fragmentPath) {
-        std::string vertexCode, fragmentCode;
-        std::ifstream vShaderFile(vertexPath), fShaderFile(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-
-        unsigned int vertex, fragment;
-        int success;
-        char infoLog[512];
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
+    unsigned int ID = 0;
+    Shader() {}
+    // includePath, if given, is pasted into the vertex stage after its #version line,
+    // fragmentIncludePath the same way into the fragment stage
+    Shader(const char* vertexPath, const char* fragmentPath, const char* includePath = nullptr,
+           const char* fragmentIncludePath = nullptr) {
+        StartupScope trace("Shader", "load", fragmentPath);
+        unsigned int vertex = compileStage(GL_VERTEX_SHADER, loadSource(vertexPath, includePath), "VERTEX");
+        unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, loadSource(fragmentPath, fragmentIncludePath), "FRAGMENT");
 
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(ID, 512, NULL, infoLog);
-            std::cout << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        }
+        link();
 
         glDeleteShader(vertex);
         glDeleteShader(fragment);
     }
 
+    // Compute program (GL 4.3), same include handling
+    static Shader compute(const char* computePath, const char* includePath = nullptr) {
+        StartupScope trace("Shader::compute", "load", computePath);
+        Shader shader;
+        unsigned int cs = compileStage(GL_COMPUTE_SHADER, loadSource(computePath, includePath), "COMPUTE");
+        shader.ID = glCreateProgram();
+        glAttachShader(shader.ID, cs);
+        shader.link();
+        glDeleteShader(cs);
+        return shader;
+    }
+
+    // Vertex + geometry program whose output is captured with transform feedback
+    // (no fragment stage; draw with GL_RASTERIZER_DISCARD). The include goes into the vertex stage.
+    static Shader feedback(const char* vertexPath, const char* geometryPath, const char* includePath,
+                           const std::vector<const char*>& varyings) {
+        StartupScope trace("Shader::feedback", "load", geometryPath);
+        Shader shader;
+        unsigned int vs = compileStage(GL_VERTEX_SHADER, loadSource(vertexPath, includePath), "VERTEX");
+        unsigned int gs = compileStage(GL_GEOMETRY_SHADER, loadSource(geometryPath, nullptr), "GEOMETRY");
+        shader.ID = glCreateProgram();
+        glAttachShader(shader.ID, vs);
+        glAttachShader(shader.ID, gs);
+        glTransformFeedbackVaryings(shader.ID, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+        shader.link();
+        glDeleteShader(vs);
+        glDeleteShader(gs);
+        return shader;
+    }
+
     void use() {
         glUseProgram(ID);
     }
@@ -71,13 +75,63 @@ public:
         glUniform1f(glGetUniformLocation(ID,n.c_str()), v); 
     }
     
+    void setVec2(const std::string& n, const glm::vec2& v) const {
+        glUniform2fv(glGetUniformLocation(ID,n.c_str()),1,&v[0]);
+    }
+
     void setVec3 (const std::string& n, const glm::vec3& v) const { 
         glUniform3fv(glGetUniformLocation(ID,n.c_str()),1,&v[0]);
     }
 
+    void setVec4(const std::string& n, const glm::vec4& v) const {
+        glUniform4fv(glGetUniformLocation(ID,n.c_str()),1,&v[0]);
+    }
+
     void setBool(const std::string& name, bool v) const {
         glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)v);
     }
 
+private:
+    static std::string loadSource(const char* path, const char* includePath) {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string code = stream.str();
+        if (includePath) {
+            std::ifstream includeFile(includePath);
+            std::stringstream includeStream;
+            includeStream << includeFile.rdbuf();
+            size_t eol = code.find('\n');
+            code.insert(eol == std::string::npos ? code.size() : eol + 1, includeStream.str() + "\n");
+        }
+        return code;
+    }
+
+    static unsigned int compileStage(GLenum type, const std::string& code, const char* label) {
+        const char* src = code.c_str();
+        unsigned int stage = glCreateShader(type);
+        glShaderSource(stage, 1, &src, NULL);
+        glCompileShader(stage);
+        int success;
+        char infoLog[512];
+        glGetShaderiv(stage, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(stage, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::" << label << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return stage;
+    }
+
+    void link() {
+        int success;
+        char infoLog[512];
+        glLinkProgram(ID);
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(ID, 512, NULL, infoLog);
+            std::cout << "ERROR::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        }
+    }
+
 };
 #endif
@@ -0,0 +1,302 @@
+#ifndef SHADOW_CASCADES_H
+#define SHADOW_CASCADES_H
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Shader.h"
+#include "Frustum.h"
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// Cascaded shadow maps for the Sun (directional light)
+// ------------------------------------------------------------
+// Instead of one big ortho box around the whole system, the visible depth
+// range is split into slices and every slice gets its own light-space box,
+// fitted to the bounding spheres of the bodies that are actually visible in
+// it. Each cascade only re-draws the casters that can land inside its box.
+//
+// Layers are also cached between frames: a cascade keeps its box and depth
+// contents until its casters (or the light direction) have moved more than
+// a threshold measured in shadow-map texels, or a receiver leaves the box.
+
+const int MAX_CASCADES = 4;
+
+// Bounding sphere of anything that can cast and/or receive a sun shadow
+struct ShadowSphere {
+    glm::vec3 center;
+    float radius;
+    bool caster;    // drawn into the depth maps
+    bool receiver;  // samples the depth maps in the main pass
+};
+
+struct ShadowCascade {
+    glm::mat4 lightSpaceMatrix = glm::mat4(1.0f);
+    float splitFar = 0.0f;        // view-space depth where this cascade ends
+    bool active = false;          // false when no visible receiver lies in the slice
+    std::vector<int> casters;     // indices into the sphere list
+
+    // what the layer currently holds
+    bool valid = false;           // layer was rendered with lightView/box/casters below
+    bool needsRender = false;     // picked for re-render this frame
+    glm::mat4 lightView = glm::mat4(1.0f);
+    glm::vec3 sunDir = glm::vec3(0.0f);
+    glm::vec3 boxMin = glm::vec3(0.0f), boxMax = glm::vec3(0.0f); // light-space box
+    std::vector<glm::vec3> casterCenters;                         // caster positions at render time
+};
+
+// Running totals; reset whenever the caller wants a new window
+struct ShadowCacheStats {
+    unsigned long cascadesRendered = 0, cascadesCached = 0;
+    unsigned long depthDrawsIssued = 0, depthDrawsSkipped = 0;
+};
+
+struct CascadedShadowMap {
+    GLuint FBO = 0, depthArray = 0;
+    unsigned int size = 1024;     // per cascade; 3 x 1024^2 is still fewer texels than one 2048^2 map
+    int count = 3;
+    float splitLambda = 0.75f;    // 0 = uniform splits, 1 = logarithmic splits
+    float cachePadding = 0.05f;   // extra box margin (fraction of extent) so cached boxes survive some motion
+    float cacheThreshold = 1.0f;  // re-render once casters drift this many texels
+    int maxUpdatesPerFrame = 1;   // budget for drift-only refreshes (round-robin); 0 = unlimited
+    int roundRobin = 0;
+    ShadowCascade cascades[MAX_CASCADES];
+    ShadowCacheStats stats;
+};
+
+static void initCascadedShadowMap(CascadedShadowMap& csm, unsigned int size = 1024, int count = 3) {
+    csm.size  = size;
+    csm.count = std::min(std::max(count, 1), MAX_CASCADES);
+
+    glGenFramebuffers(1, &csm.FBO);
+
+    glGenTextures(1, &csm.depthArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, csm.depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24,
+                 csm.size, csm.size, csm.count, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    trackTexture(csm.depthArray, textureBytes(GL_DEPTH_COMPONENT24, csm.size, csm.size, csm.count, false),
+                 "CascadedShadowMap", "cascades", "shadow");
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, csm.FBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, csm.depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// light looks along sunDir; +Z in light space points back towards the light
+static glm::mat4 shadowLightView(const glm::vec3& sunDir) {
+    glm::vec3 up = std::fabs(sunDir.y) > 0.99f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+    return glm::lookAt(glm::vec3(0.0f), sunDir, up);
+}
+
+// casters whose light-space footprint overlaps [lo, hi] and that are not
+// entirely behind every receiver; returns the highest caster z
+static float collectShadowCasters(const glm::mat4& lightView, const glm::vec3& lo, const glm::vec3& hi,
+                                  const std::vector<ShadowSphere>& spheres, std::vector<int>& out) {
+    out.clear();
+    float casterTop = hi.z;
+    for (int i = 0; i < (int)spheres.size(); ++i) {
+        const ShadowSphere& s = spheres[i];
+        if (!s.caster) continue;
+        glm::vec3 ls = glm::vec3(lightView * glm::vec4(s.center, 1.0f));
+        if (ls.x + s.radius < lo.x || ls.x - s.radius > hi.x) continue;
+        if (ls.y + s.radius < lo.y || ls.y - s.radius > hi.y) continue;
+        if (ls.z + s.radius < lo.z) continue;
+        casterTop = std::max(casterTop, ls.z + s.radius);
+        out.push_back(i);
+    }
+    return casterTop;
+}
+
+// Fits a fresh box around the receiver bounds [lo, hi] (current light space)
+// and marks the cascade for rendering.
+static void refitShadowCascade(CascadedShadowMap& csm, ShadowCascade& cascade,
+                               const glm::mat4& lightView, const glm::vec3& sunDir,
+                               glm::vec3 lo, glm::vec3 hi,
+                               const std::vector<ShadowSphere>& spheres) {
+    float pad = std::max(hi.x - lo.x, hi.y - lo.y) * csm.cachePadding;
+    lo -= glm::vec3(pad, pad, 0.0f);
+    hi += glm::vec3(pad, pad, 0.0f);
+
+    // square box snapped to whole texels so the map doesn't shimmer while bodies orbit
+    float extent = std::max(hi.x - lo.x, hi.y - lo.y);
+    float texel  = extent / (float)csm.size;
+    extent += 2.0f * texel;
+    float minX = std::floor((lo.x - texel) / texel) * texel;
+    float minY = std::floor((lo.y - texel) / texel) * texel;
+
+    // casters are collected against the final box so the cache check sees the same set
+    const float zMargin = 1.0f;
+    cascade.boxMin = glm::vec3(minX, minY, lo.z - zMargin);
+    cascade.boxMax = glm::vec3(minX + extent, minY + extent, hi.z);
+    float casterTop = collectShadowCasters(lightView, cascade.boxMin, cascade.boxMax, spheres, cascade.casters);
+    cascade.boxMax.z = casterTop + zMargin;
+
+    glm::mat4 lightProj = glm::ortho(cascade.boxMin.x, cascade.boxMax.x, cascade.boxMin.y, cascade.boxMax.y,
+                                     -cascade.boxMax.z, -cascade.boxMin.z);
+    cascade.lightSpaceMatrix = lightProj * lightView;
+    cascade.lightView = lightView;
+    cascade.sunDir = sunDir;
+
+    cascade.casterCenters.clear();
+    for (int i : cascade.casters) cascade.casterCenters.push_back(spheres[i].center);
+    cascade.needsRender = true;
+}
+
+// -------------------------------------------
+// Per-frame fit of every cascade
+// -------------------------------------------
+// view/projection are the camera matrices, near/far the camera clip range,
+// sunDir the direction the light travels in. Decides which layers have to be
+// re-rendered this frame; the rest keep their cached contents.
+static void updateShadowCascades(CascadedShadowMap& csm,
+                                 const glm::mat4& view, const glm::mat4& projection,
+                                 float nearPlane, float farPlane,
+                                 const glm::vec3& sunDir,
+                                 const std::vector<ShadowSphere>& spheres) {
+    Frustum frustum = extractFrustum(projection * view);
+
+    // visible receivers and the view-depth range they actually cover
+    std::vector<int> visible;
+    float depthMin = farPlane, depthMax = nearPlane;
+    for (int i = 0; i < (int)spheres.size(); ++i) {
+        const ShadowSphere& s = spheres[i];
+        if (!s.receiver || !sphereInFrustum(frustum, s.center, s.radius)) continue;
+        float d = -(view * glm::vec4(s.center, 1.0f)).z;
+        depthMin = std::min(depthMin, d - s.radius);
+        depthMax = std::max(depthMax, d + s.radius);
+        visible.push_back(i);
+    }
+    depthMin = std::max(depthMin, nearPlane);
+    depthMax = std::min(depthMax, farPlane);
+
+    glm::mat4 lightView = shadowLightView(sunDir);
+
+    std::vector<int> drifted;     // cached but stale by more than the threshold
+    std::vector<int> casters;
+    glm::vec3 fitLo[MAX_CASCADES], fitHi[MAX_CASCADES];
+    float sliceNear = depthMin;
+    for (int c = 0; c < csm.count; ++c) {
+        ShadowCascade& cascade = csm.cascades[c];
+        cascade.needsRender = false;
+        cascade.active = false;
+
+        // practical split scheme over the visible range only
+        float p = (float)(c + 1) / csm.count;
+        float logSplit = depthMin * std::pow(depthMax / std::max(depthMin, 1e-3f), p);
+        float uniSplit = depthMin + (depthMax - depthMin) * p;
+        float sliceFar = glm::mix(uniSplit, logSplit, csm.splitLambda);
+        cascade.splitFar = (c == csm.count - 1) ? farPlane : sliceFar;
+
+        // tight bounds of the receivers overlapping this slice, in the current
+        // light space and in the space the cached layer was rendered with
+        glm::vec3 lo(1e30f), hi(-1e30f);
+        bool covered = cascade.valid;
+        for (int i : visible) {
+            const ShadowSphere& s = spheres[i];
+            float d = -(view * glm::vec4(s.center, 1.0f)).z;
+            if (d + s.radius < sliceNear || d - s.radius > sliceFar) continue;
+            glm::vec3 ls = glm::vec3(lightView * glm::vec4(s.center, 1.0f));
+            lo = glm::min(lo, ls - glm::vec3(s.radius));
+            hi = glm::max(hi, ls + glm::vec3(s.radius));
+            cascade.active = true;
+
+            if (covered) {
+                glm::vec3 cs = glm::vec3(cascade.lightView * glm::vec4(s.center, 1.0f));
+                covered = cs.x - s.radius >= cascade.boxMin.x && cs.x + s.radius <= cascade.boxMax.x &&
+                          cs.y - s.radius >= cascade.boxMin.y && cs.y + s.radius <= cascade.boxMax.y &&
+                          cs.z - s.radius >= cascade.boxMin.z;
+            }
+        }
+        sliceNear = sliceFar;
+        fitLo[c] = lo;
+        fitHi[c] = hi;
+        if (!cascade.active) continue;
+
+        // the cached box must still see exactly the same casters
+        if (covered) {
+            collectShadowCasters(cascade.lightView, cascade.boxMin, cascade.boxMax, spheres, casters);
+            covered = casters == cascade.casters;
+            for (int i : casters) { // a caster drifting past the near plane would get clipped
+                glm::vec3 cs = glm::vec3(cascade.lightView * glm::vec4(spheres[i].center, 1.0f));
+                if (cs.z + spheres[i].radius > cascade.boxMax.z) covered = false;
+            }
+        }
+        if (!covered) {
+            refitShadowCascade(csm, cascade, lightView, sunDir, lo, hi, spheres);
+            continue;
+        }
+
+        // drift of the cached layer: caster motion across the map plus the
+        // shadow offset from the light having rotated since it was rendered
+        float drift = 0.0f;
+        for (size_t k = 0; k < cascade.casters.size(); ++k) {
+            glm::vec3 now  = glm::vec3(cascade.lightView * glm::vec4(spheres[cascade.casters[k]].center, 1.0f));
+            glm::vec3 then = glm::vec3(cascade.lightView * glm::vec4(cascade.casterCenters[k], 1.0f));
+            drift = std::max(drift, glm::length(glm::vec2(now.x - then.x, now.y - then.y)));
+        }
+        float angle = std::acos(glm::clamp(glm::dot(sunDir, cascade.sunDir), -1.0f, 1.0f));
+        drift += angle * (cascade.boxMax.z - cascade.boxMin.z);
+
+        float texel = (cascade.boxMax.x - cascade.boxMin.x) / (float)csm.size;
+        if (drift > csm.cacheThreshold * texel) drifted.push_back(c);
+    }
+
+    // drift-only refreshes share a per-frame budget, handed out round-robin
+    int budget = csm.maxUpdatesPerFrame > 0 ? csm.maxUpdatesPerFrame : (int)drifted.size();
+    for (int n = 0; n < csm.count && budget > 0 && !drifted.empty(); ++n) {
+        int c = (csm.roundRobin + n) % csm.count;
+        if (std::find(drifted.begin(), drifted.end(), c) == drifted.end()) continue;
+        refitShadowCascade(csm, csm.cascades[c], lightView, sunDir, fitLo[c], fitHi[c], spheres);
+        csm.roundRobin = (c + 1) % csm.count;
+        budget--;
+    }
+}
+
+// Binds the cascade's layer as depth target. Returns false (and does nothing)
+// when the cascade has no receivers or its cached layer is still good enough.
+static bool beginShadowCascade(CascadedShadowMap& csm, int c, Shader& depthShader) {
+    ShadowCascade& cascade = csm.cascades[c];
+    if (!cascade.active) return false;
+    if (!cascade.needsRender) {
+        csm.stats.cascadesCached++;
+        csm.stats.depthDrawsSkipped += cascade.casters.size();
+        return false;
+    }
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, csm.depthArray, 0, c);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    depthShader.setMat4("lightSpaceMatrix", cascade.lightSpaceMatrix);
+
+    cascade.valid = true;
+    cascade.needsRender = false;
+    csm.stats.cascadesRendered++;
+    csm.stats.depthDrawsIssued += cascade.casters.size();
+    return true;
+}
+
+// Uploads matrices/splits to the main shader and binds the depth array to the given unit
+static void bindShadowCascades(const CascadedShadowMap& csm, Shader& shader, int unit) {
+    for (int c = 0; c < csm.count; ++c) {
+        std::string idx = "[" + std::to_string(c) + "]";
+        shader.setMat4("lightSpaceMatrices" + idx, csm.cascades[c].lightSpaceMatrix);
+        shader.setFloat("cascadeSplits" + idx, csm.cascades[c].splitFar);
+    }
+    shader.setInt("cascadeCount", csm.count);
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, csm.depthArray);
+    shader.setInt("shadowMap", unit);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+#endif
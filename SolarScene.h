@@ -0,0 +1,641 @@
+#ifndef SOLAR_SCENE_H
+#define SOLAR_SCENE_H
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Shader.h"
+#include "PlanetRenderer.h"
+#include "SolarSystem.h"
+#include "ObjLoader.h"
+#include "ShadowCascades.h"
+#include "PointShadow.h"
+#include "AnalyticShadows.h"
+#include "RenderSettings.h"
+#include "MeshArena.h"
+#include "AlbedoArray.h"
+#include "DrawList.h"
+#include "AsteroidBelt.h"
+#include "FragmentCounter.h"
+#include "OcclusionQueries.h"
+#include "StreamBuffer.h"
+#include "ClusteredLights.h"
+#include "DeferredShading.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "StartupTimer.h"
+#include "PostProcess.h"
+
+// ------------------------------------------------------------
+// The solar system scene, shared by main.cpp and bench.cpp
+// ------------------------------------------------------------
+// initSolarScene() loads and creates everything once a GL context is current;
+// renderSolarFrame() draws one frame from a SolarFrame (camera matrices and
+// the simulation time) into the default framebuffer. Neither reads input or
+// the clock, so the same frame can be replayed exactly: main fills SolarFrame
+// from the live camera, bench from a scripted path.
+//
+// Whichever executable includes this defines STB_IMAGE_IMPLEMENTATION and
+// includes stb_image.h first (one translation unit per executable, apart from
+// ObjLoader.cpp); the implementation section has no include guard, so this
+// header doesn't include it again.
+
+// fixed sampler units: albedo array 0, cascades 1, earth cube 2, draw data 3, belt instances 4,
+// clustered lights 5-7, G-buffer 8-10, post-processing 11-13, overlay font 14
+const int DRAW_DATA_UNIT = 3;
+const int BELT_UNIT = 4;
+const int LIGHTS_UNIT = 5;
+const int GBUFFER_UNIT = 8;
+const int POST_UNIT = 11;
+const int OVERLAY_UNIT = 14;
+
+// Loads an image file into a GL_TEXTURE_2D (AlbedoArray.h declares it), with
+// mipmaps unless `mips` is false (AlbedoArray's staging copies only get blitted).
+// Not static: this header is the one place it is defined in each executable.
+GLuint loadTexture(const char* path, bool mips) {
+    StartupScope trace("loadTexture", "load", path);
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
+    if (data) {
+        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        if (mips) glGenerateMipmap(GL_TEXTURE_2D);
+        trackTexture(textureID, textureBytes(format, width, height, 1, mips), "loadTexture", path, "staging");
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mips ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    } else {
+        std::cerr << "Failed to load texture at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
+
+// FrameData uniform block in vertex.glsl / fragment.glsl (std140)
+struct FrameUniforms {
+    glm::mat4 viewProjection;
+    glm::mat4 view;
+    glm::vec4 viewPos;
+};
+
+struct SolarScene {
+    // switches; main.cpp's keys flip the first three between frames
+    bool earthLightOn = true;
+    bool depthPrepass = false;
+    bool occlusionCulling = true;
+    bool deferred = false;
+    bool shadowMaps = true;      // fixed at init (--shadows)
+    bool multiDraw = false;      // driver capability, fixed at init
+
+    CascadedShadowMap csm;
+    PointShadowMap earthShadow;
+    Shader shader, gbufferShader, lightShader, depthShader, depthAlphaShader, pointShadowShader;
+
+    MeshArena arena;
+    MeshRange sphereMesh, ringsMesh, probeMesh, proxyMesh, rockMesh;
+    AlbedoArray albedo;
+    SolarLayers layers;
+    AsteroidBelt belt;
+
+    StreamBuffer frameStream;
+    GLint uniformAlign = 256;
+    DrawList drawList;
+    DrawBatch drawBatch;
+    GLStateCache glState;
+    FragmentCounter fragmentCounter;
+    Profiler profiler;           // CPU / GPU zones per frame section
+    GBuffer gbuffer;             // sized on first use
+    PostProcess post;            // HDR target, bloom, auto exposure, tonemap
+
+    // clustered point lights, binned on the CPU every frame (near/far = the camera's)
+    std::vector<OrbitLight> orbitLights;
+    std::vector<ClusterLight> clusterLights;
+    ClusteredLights lightClusters;
+    OcclusionQueries occlusion;
+    bool occlusionInit = false;  // sized on the first frame, once the sphere list exists
+    unsigned long occludedBodies = 0;   // proxies whose results this frame said hidden
+};
+
+// What one frame is drawn from
+struct SolarFrame {
+    glm::vec3 eye = glm::vec3(0.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    float time = 0.0f;           // simulation time: orbits, belt, light blinks
+    float sunTime = 0.0f;        // sun direction (main keeps it off the "3" key's time boost)
+    float deltaTime = 0.0f;      // seconds since the last frame, for exposure adaptation
+    int width = 0, height = 0;   // framebuffer size
+};
+
+// Everything after context creation; the context must stay current
+static void initSolarScene(SolarScene& scene, const RenderSettings& settings) {
+    scene.shadowMaps = settings.shadowMode == ShadowMode::Maps;
+    scene.depthPrepass = settings.depthPrepass;
+    scene.occlusionCulling = settings.occlusionCulling;
+    scene.deferred = settings.shading == ShadingPath::Deferred;
+
+    glEnable(GL_DEPTH_TEST); // depth buffer
+    glDisable(GL_CULL_FACE);
+    glFrontFace(GL_CW); // Use clockwise as front-facing instead of default CCW
+
+    // ====== SHADOW MAP INIT ======
+    StartupScope shadowTrace("shadow maps", "startup");
+    // 3 cascades of 1024^2 fitted to the visible bodies every frame; layers are
+    // cached and at most one drifted cascade is refreshed per frame
+    if (scene.shadowMaps) initCascadedShadowMap(scene.csm, 1024, 3);
+    scene.csm.cacheThreshold = 1.0f;
+    scene.csm.maxUpdatesPerFrame = 1;
+
+    // cube shadow for earthLight: 512^2 faces, at most one stale face re-rendered per frame
+    if (scene.shadowMaps) initPointShadowMap(scene.earthShadow, 512, 20.0f);
+    scene.earthShadow.maxFacesPerFrame = 1;
+    shadowTrace.end();
+    // ====== END SHADOW MAP INIT ======
+
+    StartupScope shaderTrace("shaders", "startup");
+    scene.shader = Shader("vertex.glsl", "fragment.glsl", "belt_instance.glsl", "lighting.glsl");
+
+    // deferred path: material-only geometry pass + fullscreen lighting (DeferredShading.h)
+    scene.gbufferShader = Shader("vertex.glsl", "gbuffer.frag", "belt_instance.glsl");
+    scene.lightShader = Shader("fullscreen.vert", "deferred_light.frag", nullptr, "lighting.glsl");
+
+    scene.depthShader = Shader("shadow_depth.vert", "shadow_depth.frag");
+    scene.depthAlphaShader = Shader("shadow_depth.vert", "shadow_alpha.frag");   // alpha-tested casters (rings)
+
+    scene.pointShadowShader = Shader("point_shadow.vert", "point_shadow.frag");
+    shaderTrace.end();
+
+    // one multi-draw per pass when the driver can (GL 4.3 or the two ARB extensions),
+    // otherwise a glDrawElementsBaseVertex loop over the same commands
+    scene.multiDraw = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+
+    // all geometry lives in one arena: the shared sphere, the ring annulus, the probe and the belt's rock
+    StartupScope meshTrace("mesh arena", "startup");
+    std::vector<float> meshVertices;
+    std::vector<unsigned int> meshIndices;
+    generateSphereMesh(meshVertices, meshIndices);
+    scene.sphereMesh = addArenaMesh(scene.arena, meshVertices, meshIndices);
+    generateRingMesh(meshVertices, meshIndices);
+    scene.ringsMesh = addArenaMesh(scene.arena, meshVertices, meshIndices);
+    float probeRadius = 0.0f;
+    parseOBJ("Asteroid/Asteroid.obj", meshVertices, meshIndices, probeRadius); // empty range on failure
+    scene.probeMesh = addArenaMesh(scene.arena, meshVertices, meshIndices);
+    generateBoxMesh(meshVertices, meshIndices);
+    scene.proxyMesh = addArenaMesh(scene.arena, meshVertices, meshIndices);   // occlusion query proxies
+    generateRockMesh(meshVertices, meshIndices);
+    scene.rockMesh = addArenaMesh(scene.arena, meshVertices, meshIndices);    // every belt asteroid
+    uploadMeshArena(scene.arena, scene.multiDraw ? 1024 : 0);
+    meshTrace.end();
+
+    // image textures of the planets, one array layer each
+    StartupScope albedoTrace("albedo array", "startup");
+    AlbedoArray& albedo = scene.albedo;
+    SolarLayers& layers = scene.layers;
+    initAlbedoArray(albedo, 2048, 1024, 14);
+    layers.sun      = addAlbedoLayer(albedo, "sun_texture.jpg");
+    layers.earth    = addAlbedoLayer(albedo, "earth_texture.jpg");
+    layers.moon     = addAlbedoLayer(albedo, "moon_texture.jpg");
+    layers.mercury  = addAlbedoLayer(albedo, "mercury_texture.jpg");
+    layers.venus    = addAlbedoLayer(albedo, "venus_texture.jpg");
+    layers.mars     = addAlbedoLayer(albedo, "mars_texture.jpg");
+    layers.phobos   = addAlbedoLayer(albedo, "phobos_texture.jpg");
+    layers.deimos   = addAlbedoLayer(albedo, "deimos_texture.jpg");
+    //TODO: get new textures for other planets
+    layers.saturn   = addAlbedoLayer(albedo, "saturn_texture.jpg");
+    layers.rings    = addAlbedoLayer(albedo, "saturnRings_texture.png");
+    layers.jupiter  = addAlbedoLayer(albedo, "jupiter_texture.jpg");
+    layers.uranus   = addAlbedoLayer(albedo, "uranus_texture.jpg");
+    layers.neptune  = addAlbedoLayer(albedo, "neptune_texture.jpg");
+    layers.asteroid = addAlbedoLayer(albedo, "Asteroid/Asteroid.jpg");
+    finishAlbedoArray(albedo);
+    albedoTrace.end();
+
+    for (Shader* s : { &scene.shader, &scene.lightShader }) {
+        s->use();
+        s->setInt("drawData", DRAW_DATA_UNIT);
+        s->setInt("lightData", LIGHTS_UNIT);
+        s->setInt("clusterLights", LIGHTS_UNIT + 1);
+        s->setInt("lightIndices", LIGHTS_UNIT + 2);
+    }
+    for (Shader* s : { &scene.shader, &scene.gbufferShader }) {
+        s->use();
+        s->setInt("albedoArray", 0);
+        s->setInt("drawData", DRAW_DATA_UNIT);
+        s->setInt("instanceData", BELT_UNIT);
+    }
+    scene.lightShader.use();
+    scene.lightShader.setInt("gAlbedo", GBUFFER_UNIT);
+    scene.lightShader.setInt("gNormal", GBUFFER_UNIT + 1);
+    scene.lightShader.setInt("gDepth", GBUFFER_UNIT + 2);
+    scene.depthShader.use();
+    scene.depthShader.setInt("drawData", DRAW_DATA_UNIT);
+    scene.depthAlphaShader.use();
+    scene.depthAlphaShader.setInt("albedoArray", 0);
+    scene.depthAlphaShader.setInt("drawData", DRAW_DATA_UNIT);
+    scene.pointShadowShader.use();
+    scene.pointShadowShader.setInt("albedoArray", 0);
+    scene.pointShadowShader.setInt("drawData", DRAW_DATA_UNIT);
+
+    // asteroid belt: instanced low-poly rocks, culled on the GPU every frame
+    bool cullCompute = settings.cullPath == CullPath::Compute ||
+                       (settings.cullPath == CullPath::Auto && gpuCullingHasCompute());
+    if (cullCompute && !gpuCullingHasCompute()) {
+        std::cerr << "Compute culling needs GL 4.3, using transform feedback" << std::endl;
+        cullCompute = false;
+    }
+    if (settings.asteroidCount > 0) {
+        StartupScope trace("asteroid belt", "startup");
+        initAsteroidBelt(scene.belt, scene.arena, scene.rockMesh, layers.asteroid, settings.asteroidCount, cullCompute);
+    }
+
+    StartupScope buffersTrace("frame buffers + targets", "startup");
+    // per-frame data (draw data, indirect commands, frame uniforms) streams through
+    // one triple-buffered ring; persistently mapped when the driver allows it
+    initStreamBuffer(scene.frameStream, 256 * 1024, streamBufferHasPersistent());
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &scene.uniformAlign);
+    for (const Shader* s : { &scene.shader, &scene.gbufferShader, &scene.lightShader })
+        glUniformBlockBinding(s->ID, glGetUniformBlockIndex(s->ID, "FrameData"), 0);
+
+    // every pass is a sorted packet list; a frame's lists are uploaded together
+    // and submitted range by range through the state cache
+    initDrawBatch(scene.drawBatch, scene.multiDraw, scene.frameStream);
+    initFragmentCounter(scene.fragmentCounter);
+    initPostProcess(scene.post);
+
+    scene.orbitLights = scatterOrbitLights(settings.lightCount);
+    scene.clusterLights.resize(scene.orbitLights.size());
+    initClusteredLights(scene.lightClusters, 0.1f, 100.0f);
+    buffersTrace.end();
+}
+
+// One frame into the default framebuffer. Profiler zones: simulation, depth pass,
+// main pass, post-processing (CPU) and depth pass, main pass, post stages (GPU).
+static void renderSolarFrame(SolarScene& scene, const SolarFrame& frame) {
+    CpuZone simulationZone(scene.profiler, "simulation");
+    glClearColor(0.0f, 0.0f, 0.05f, 1.0f); // clears screen
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    scene.glState.invalidate();
+    scene.glState.stats = DrawStats();
+
+    const glm::mat4& view = frame.view;
+    const glm::mat4& projection = frame.projection;
+    glm::mat4 viewProjection = projection * view;
+    const float time = frame.time;
+    const int fbw = frame.width, fbh = frame.height;
+
+    std::vector<SceneBody> bodies = solarBodies(scene.sphereMesh, scene.layers, time);
+    const int sunIndex   = SUN_BODY;
+    const int earthIndex = EARTH_BODY;
+    glm::vec3 earthPosition = bodies[EARTH_BODY].position;
+    float earthScale = bodies[EARTH_BODY].scale;
+    glm::vec3 saturnRingsPosition = bodies[SATURN_BODY].position;
+    float saturnRingsScale = bodies[SATURN_BODY].scale * 2.0f; // scale for rings
+
+    glm::vec3 probePosition = glm::vec3(25.0f, 0.0f, -5.0f);
+    float probeScale = 0.001f;
+
+    // bounding spheres for cascade fitting: bodies first (same indices), then rings, then the probe
+    std::vector<ShadowSphere> shadowSpheres;
+    for (const SceneBody& b : bodies)
+        shadowSpheres.push_back({ b.position, b.scale, b.castsShadow, b.castsShadow });
+    // (rings cast alpha-tested into the shadow maps; a sphere would be a poor analytic occluder)
+    shadowSpheres.push_back({ saturnRingsPosition, saturnRingsScale, scene.shadowMaps, true });
+    const int ringsSphere = (int)shadowSpheres.size() - 1;
+    const int probeSphere = (int)shadowSpheres.size();
+    shadowSpheres.push_back({ probePosition, scene.probeMesh.radius * probeScale, true, true });
+
+   // === Sun light direction + cascade fit ===
+    glm::vec3 sunDir = glm::normalize(glm::vec3(cos(frame.sunTime), 0.1f, sin(frame.sunTime)));
+
+    if (scene.shadowMaps)
+        updateShadowCascades(scene.csm, view, projection, 0.1f, 100.0f, sunDir, shadowSpheres);
+
+    // ====== ASTEROID BELT CULL ======
+    // goes around the state cache (own program, VAO and units)
+    cullAsteroidBelt(scene.belt, extractFrustum(viewProjection), time, frame.eye, BELT_UNIT);
+    scene.glState.invalidate();
+
+    // ====== CLUSTERED LIGHTS ======
+    moveOrbitLights(scene.orbitLights, scene.clusterLights, time);
+    buildLightClusters(scene.lightClusters, scene.clusterLights, view, projection);
+
+    glm::mat4 probeModelMatrix = glm::translate(glm::mat4(1.0f), probePosition);
+    probeModelMatrix = glm::scale(probeModelMatrix, glm::vec3(probeScale));
+
+    glm::mat4 ringsModelMatrix = ringModelMatrix(saturnRingsPosition, saturnRingsScale);
+
+    // queues shadowSpheres[i] (body, rings or probe)
+    auto addDraw = [&](int i, GLuint program, float depth01,
+                       unsigned int flags = 0, const OccluderSet* occ = nullptr) {
+        if (i == probeSphere) {
+            scene.drawList.add(PASS_OPAQUE, program, scene.probeMesh, scene.layers.asteroid, probeModelMatrix, depth01, flags, occ);
+        } else if (i == ringsSphere) {
+            scene.drawList.add(PASS_TRANSPARENT, program, scene.ringsMesh, scene.layers.rings, ringsModelMatrix, depth01,
+                         flags | DRAW_ALPHA_TEST, occ);
+        } else {
+            const SceneBody& b = bodies[i];
+            scene.drawList.add(PASS_OPAQUE, program, b.mesh, b.layer,
+                         planetModelMatrix(b.position, b.scale, b.spin, b.tilt), depth01, flags, occ);
+        }
+    };
+
+    // analytic mode: each body only gets the spheres that can eclipse it
+    std::vector<OccluderSet> occluders(shadowSpheres.size());
+    if (!scene.shadowMaps) {
+        for (int i = 0; i < (int)shadowSpheres.size(); ++i)
+            gatherOccluders(occluders[i], i, shadowSpheres, -sunDir, 0.02f,
+                            scene.earthLightOn, earthPosition, earthScale, earthIndex);
+    }
+
+    // ====== BUILD EVERY PASS, UPLOAD ONCE ======
+    // depth lists only for the cascades / cube faces that will actually be redrawn
+    beginDrawBatch(scene.drawBatch);
+    int cascadeRange[MAX_CASCADES] = { -1, -1, -1, -1 };
+    int cascadeRingsRange[MAX_CASCADES] = { -1, -1, -1, -1 };   // alpha-tested, own program
+    int faceRange[6] = { -1, -1, -1, -1, -1, -1 };
+    if (scene.shadowMaps) {
+        for (int c = 0; c < scene.csm.count; ++c) {
+            if (!scene.csm.cascades[c].active || !scene.csm.cascades[c].needsRender) continue;
+            bool rings = false;
+            scene.drawList.clear();
+            for (int i : scene.csm.cascades[c].casters) {
+                if (i == ringsSphere) rings = true;
+                else addDraw(i, scene.depthShader.ID, 0.0f);
+            }
+            cascadeRange[c] = addToDrawBatch(scene.drawBatch, scene.drawList);
+            if (rings) {
+                scene.drawList.clear();
+                addDraw(ringsSphere, scene.depthAlphaShader.ID, 0.0f);
+                cascadeRingsRange[c] = addToDrawBatch(scene.drawBatch, scene.drawList);
+            }
+        }
+        // Earth itself never casts (the light is inside it); point_shadow.frag
+        // alpha-tests the rings itself since it writes gl_FragDepth anyway
+        if (scene.earthLightOn) {
+            updatePointShadow(scene.earthShadow, earthPosition, shadowSpheres, earthIndex);
+            for (int f = 0; f < 6; ++f) {
+                if (!scene.earthShadow.faces[f].needsRender) continue;
+                scene.drawList.clear();
+                for (int i : scene.earthShadow.faces[f].casters) addDraw(i, scene.pointShadowShader.ID, 0.0f);
+                faceRange[f] = addToDrawBatch(scene.drawBatch, scene.drawList);
+            }
+        }
+    }
+
+    // main pass: opaque draws front to back, the blended rings on their own afterwards.
+    // With occlusion culling every body but the Sun is a candidate, drawn on its
+    // own under last frame's query for its proxy box.
+    if (!scene.occlusionInit) {
+        initOcclusionQueries(scene.occlusion, (int)shadowSpheres.size());
+        scene.occlusionInit = true;
+    }
+    auto cameraDepth = [&](int i) {
+        return glm::length(shadowSpheres[i].center - frame.eye) / 100.0f;
+    };
+    auto occlusionCandidate = [&](int i) {
+        return scene.occlusionCulling && i != sunIndex && i != ringsSphere;
+    };
+    // opaque surfaces: lit directly (forward) or written to the G-buffer (deferred)
+    Shader& surfaceShader = scene.deferred ? scene.gbufferShader : scene.shader;
+    auto addMainDraw = [&](int i) {
+        unsigned int flags = (i == sunIndex ? DRAW_SUN : 0) | (i == earthIndex ? DRAW_EARTH : 0);
+        addDraw(i, surfaceShader.ID, cameraDepth(i), flags, scene.shadowMaps ? nullptr : &occluders[i]);
+    };
+    scene.drawList.clear();
+    for (int i = 0; i < (int)shadowSpheres.size(); ++i)
+        if (i != ringsSphere && !occlusionCandidate(i)) addMainDraw(i);
+    int mainRange = addToDrawBatch(scene.drawBatch, scene.drawList);
+
+    scene.drawList.clear();
+    for (int i = 0; i < (int)shadowSpheres.size(); ++i) {
+        if (!occlusionCandidate(i)) continue;
+        addMainDraw(i);
+        scene.drawList.packets.back().tag = i;
+    }
+    int candidateRange = addToDrawBatch(scene.drawBatch, scene.drawList);
+
+    // proxy boxes, slightly inflated; none when the camera could be inside one
+    scene.drawList.clear();
+    for (int i = 0; i < (int)shadowSpheres.size(); ++i) {
+        if (!occlusionCandidate(i)) continue;
+        float half = shadowSpheres[i].radius * 1.05f;
+        if (glm::length(frame.eye - shadowSpheres[i].center) < half * 1.7321f + 0.1f) continue;
+        glm::mat4 proxyModel = glm::scale(glm::translate(glm::mat4(1.0f), shadowSpheres[i].center), glm::vec3(half));
+        scene.drawList.add(PASS_OPAQUE, scene.depthShader.ID, scene.proxyMesh, 0, proxyModel, cameraDepth(i), 0, nullptr, i);
+    }
+    int proxyRange = addToDrawBatch(scene.drawBatch, scene.drawList);
+
+    scene.drawList.clear();
+    addDraw(ringsSphere, scene.shader.ID, cameraDepth(ringsSphere), 0, scene.shadowMaps ? nullptr : &occluders[ringsSphere]);
+    int ringsRange = addToDrawBatch(scene.drawBatch, scene.drawList);
+
+    // depth pre-pass: the same opaque bodies with the depth-only program
+    int prepassRange = -1;
+    if (scene.depthPrepass) {
+        scene.drawList.clear();
+        for (int i = 0; i < (int)shadowSpheres.size(); ++i)
+            if (i != ringsSphere) addDraw(i, scene.depthShader.ID, cameraDepth(i));
+        prepassRange = addToDrawBatch(scene.drawBatch, scene.drawList);
+    }
+
+    // draw data first (see writeDrawBatch), then the frame uniforms
+    beginStreamFrame(scene.frameStream);
+    writeDrawBatch(scene.drawBatch, scene.frameStream);
+    FrameUniforms frameUniforms = { viewProjection, view, glm::vec4(frame.eye, 1.0f) };
+    StreamAlloc frameAlloc = streamWrite(scene.frameStream, &frameUniforms, sizeof(frameUniforms), scene.uniformAlign);
+    flushStream(scene.frameStream);
+    bindDrawBatch(scene.drawBatch, scene.frameStream, scene.glState, DRAW_DATA_UNIT);
+    glBindBufferRange(GL_UNIFORM_BUFFER, 0, scene.frameStream.buffer, frameAlloc.offset, frameAlloc.size);
+
+    simulationZone.end();
+
+    // ====== DEPTH PASS ======
+    // one layer per cascade, each with only the casters that can reach its box
+    // (analytic mode has no depth passes at all)
+    CpuZone depthZone(scene.profiler, "depth pass");
+    if (scene.shadowMaps) {
+        GpuZone depthGpuZone(scene.profiler, "depth pass");
+        glViewport(0, 0, scene.csm.size, scene.csm.size);
+        glBindFramebuffer(GL_FRAMEBUFFER, scene.csm.FBO);
+
+        scene.glState.bindTexture(0, GL_TEXTURE_2D_ARRAY, scene.albedo.texture);   // ring alpha
+        scene.glState.useProgram(scene.depthShader.ID);
+        for (int c = 0; c < scene.csm.count; ++c) {
+            if (!beginShadowCascade(scene.csm, c, scene.depthShader)) continue;
+            submitDrawBatch(scene.drawBatch, cascadeRange[c], scene.arena, scene.glState);
+            if (cascadeRingsRange[c] >= 0) {
+                scene.glState.useProgram(scene.depthAlphaShader.ID);
+                scene.depthAlphaShader.setMat4("lightSpaceMatrix", scene.csm.cascades[c].lightSpaceMatrix);
+                submitDrawBatch(scene.drawBatch, cascadeRingsRange[c], scene.arena, scene.glState);
+                scene.glState.useProgram(scene.depthShader.ID);
+            }
+        }
+
+        // ====== EARTH LIGHT CUBE SHADOW ======
+        // skipped entirely while the light is off
+        if (scene.earthLightOn) {
+            glViewport(0, 0, scene.earthShadow.size, scene.earthShadow.size);
+            glBindFramebuffer(GL_FRAMEBUFFER, scene.earthShadow.FBO);
+            scene.glState.useProgram(scene.pointShadowShader.ID);
+            scene.pointShadowShader.setVec3("lightPos", earthPosition);
+            scene.pointShadowShader.setFloat("farPlane", scene.earthShadow.farPlane);
+            for (int f = 0; f < 6; ++f) {
+                if (!beginPointShadowFace(scene.earthShadow, f, scene.pointShadowShader)) continue;
+                submitDrawBatch(scene.drawBatch, faceRange[f], scene.arena, scene.glState);
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    depthZone.end();
+
+   // ====== MAIN PASS ======
+    CpuZone mainZone(scene.profiler, "main pass");
+    GpuZone mainGpuZone(scene.profiler, "main pass");
+    resizePostProcess(scene.post, fbw, fbh);   // full window size (HiDPI safe)
+    if (scene.deferred) {
+        resizeGBuffer(scene.gbuffer, fbw, fbh);
+        beginGeometryPass(scene.gbuffer);
+    } else {
+        beginHdrScene(scene.post);
+    }
+
+    // everything lighting.glsl reads, for the forward shader or the deferred lighting pass
+    auto setLighting = [&](Shader& s) {
+        scene.glState.useProgram(s.ID);
+        // === SUN directional light (bright + warm) ===
+        s.setVec3("sun.direction", sunDir);
+        s.setVec3("sun.ambient",   glm::vec3(0.6f, 0.5f, 0.4f));
+        s.setVec3("sun.diffuse",   glm::vec3(5.0f, 4.0f, 3.0f));
+        s.setVec3("sun.specular",  glm::vec3(2.5f, 2.3f, 2.0f));
+
+        s.setVec3("earthLight.position",  earthPosition);
+        s.setVec3("earthLight.ambient",   glm::vec3(0.2f, 0.2f, 0.4f));
+        s.setVec3("earthLight.diffuse", scene.earthLightOn ? glm::vec3(2.0f, 2.6f, 3.6f) : glm::vec3(0.0f));
+        s.setVec3("earthLight.specular", scene.earthLightOn ? glm::vec3(1.2f, 1.4f, 2.2f) : glm::vec3(0.0f));
+        s.setFloat("earthLight.constant",  1.0f);
+        s.setFloat("earthLight.linear",    0.0f);
+        s.setFloat("earthLight.quadratic", 0.0f);
+
+        // shadow cascades on unit 1
+        bindShadowCascades(scene.csm, s, 1);
+        // earth light cube on unit 2
+        bindPointShadow(scene.earthShadow, s, 2);
+        scene.glState.activeUnit = -1; // both helpers switch units behind the cache
+        bindClusteredLights(scene.lightClusters, s, scene.glState, LIGHTS_UNIT, fbw, fbh);
+        s.setBool("earthShadowOn", scene.earthLightOn);
+        s.setInt("shadowMode", scene.shadowMaps ? 0 : 1);
+        s.setFloat("sunAngularRadius", 0.02f);
+        s.setFloat("earthLightRadius", earthScale);
+    };
+
+    // optional depth pre-pass: lay down opaque depth first so the expensive
+    // shading below only runs on the front-most fragment (LEQUAL, no depth writes)
+    if (scene.depthPrepass) {
+        scene.glState.useProgram(scene.depthShader.ID);
+        scene.depthShader.setMat4("lightSpaceMatrix", viewProjection);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        submitDrawBatch(scene.drawBatch, prepassRange, scene.arena, scene.glState);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    beginFragmentCount(scene.fragmentCounter);
+    if (scene.deferred) scene.glState.useProgram(scene.gbufferShader.ID);
+    else setLighting(scene.shader);
+
+    // planet/albedo textures: the whole array on unit 0
+    scene.glState.bindTexture(0, GL_TEXTURE_2D_ARRAY, scene.albedo.texture);
+    submitDrawBatch(scene.drawBatch, mainRange, scene.arena, scene.glState);
+    for (GLsizei k = 0; k < scene.drawBatch.ranges[candidateRange].count; ++k) {
+        int i = scene.drawBatch.tags[scene.drawBatch.ranges[candidateRange].first + k];
+        GLuint query = occlusionCondition(scene.occlusion, i);
+        if (query) glBeginConditionalRender(query, GL_QUERY_NO_WAIT);
+        submitDrawBatchCommand(scene.drawBatch, candidateRange, k, scene.arena, scene.glState);
+        if (query) glEndConditionalRender();
+    }
+    if (scene.depthPrepass) {
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+    }
+    // belt and rings aren't in the pre-pass; they depth test normally
+    drawAsteroidBelt(scene.belt, surfaceShader, time);
+    scene.glState.invalidate();
+    if (scene.belt.count > 0)   // compute path: the count read back a frame or two late
+        scene.glState.stats.triangles += (unsigned long)scene.belt.culler.visibleCount * (scene.belt.culler.mesh.indexCount / 3);
+
+    // deferred: one lighting pass over the covered pixels, then the rest on top of it
+    if (scene.deferred) {
+        setLighting(scene.lightShader);
+        runLightingPass(scene.gbuffer, scene.lightShader, scene.glState, GBUFFER_UNIT, glm::inverse(viewProjection),
+                        glm::vec4(0.0f, 0.0f, 0.05f, 1.0f));
+        beginForwardOverGBuffer(scene.gbuffer);
+        setLighting(scene.shader);
+    }
+
+    // rings last, blended back to front (PASS_TRANSPARENT keys) over the finished
+    // opaque depth without writing any: a flat annulus never overlaps itself, and
+    // the occlusion proxies below still see through its gaps
+    scene.glState.useProgram(scene.shader.ID);
+    scene.glState.bindTexture(0, GL_TEXTURE_2D_ARRAY, scene.albedo.texture);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    submitDrawBatch(scene.drawBatch, ringsRange, scene.arena, scene.glState);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    endFragmentCount(scene.fragmentCounter);
+    mainGpuZone.end();
+    mainZone.end();
+
+    // ====== OCCLUSION QUERIES ======
+    // proxies against this frame's finished depth; next frame's draws are conditioned on them
+    unsigned long hiddenBefore = scene.occlusion.hidden;
+    if (scene.occlusionCulling) {
+        std::vector<char> queried(shadowSpheres.size(), 0);
+        scene.glState.useProgram(scene.depthShader.ID);
+        scene.depthShader.setMat4("lightSpaceMatrix", viewProjection);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        for (GLsizei k = 0; k < scene.drawBatch.ranges[proxyRange].count; ++k) {
+            int i = scene.drawBatch.tags[scene.drawBatch.ranges[proxyRange].first + k];
+            beginOcclusionQuery(scene.occlusion, i);
+            submitDrawBatchCommand(scene.drawBatch, proxyRange, k, scene.arena, scene.glState);
+            endOcclusionQuery(scene.occlusion);
+            queried[i] = 1;
+        }
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        for (int i = 0; i < (int)queried.size(); ++i)
+            if (!queried[i]) skipOcclusionQuery(scene.occlusion, i);
+        swapOcclusionQueries(scene.occlusion);
+    } else {
+        resetOcclusionQueries(scene.occlusion);
+    }
+    scene.occludedBodies = scene.occlusion.hidden - hiddenBefore;
+
+    // ====== POST-PROCESSING ======
+    // linear HDR -> window: bloom, auto exposure, tonemap (the only tonemap now)
+    CpuZone postZone(scene.profiler, "post-processing");
+    runPostProcess(scene.post, scene.deferred ? scene.gbuffer.lit : scene.post.sceneColor, frame.deltaTime,
+                   scene.glState, POST_UNIT, scene.profiler);
+    postZone.end();
+    endStreamFrame(scene.frameStream);
+}
+
+#endif
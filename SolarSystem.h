@@ -0,0 +1,193 @@
+#ifndef SOLAR_SYSTEM_H
+#define SOLAR_SYSTEM_H
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "PlanetRenderer.h"
+#include "ClusterLight.h"
+
+// ------------------------------------------------------------
+// Where everything in the solar system is: pure math, no GL
+// ------------------------------------------------------------
+// The bodies' orbits and the small orbiting lights, apart from SolarScene.h
+// so microbench can time them without the renderer.
+
+// body order in solarBodies(); the shadow sphere list keeps the same indices
+const int SUN_BODY = 0;
+const int EARTH_BODY = 1;
+const int SATURN_BODY = 10;
+
+// Small lights for the clustered path, each on its own circular orbit in the
+// planets' band: steady city-light warm whites, blinking red/green beacons and
+// bright blue-white flares
+struct OrbitLight {
+    float radius, phase, speed, height;
+    float range;
+    glm::vec3 color;
+    float blink;   // Hz, 0 = steady
+};
+
+static std::vector<OrbitLight> scatterOrbitLights(int count) {
+    std::vector<OrbitLight> lights;
+    std::mt19937 rng(2201);   // fixed seed: same lights every run
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < count; ++i) {
+        OrbitLight l;
+        l.radius = 5.0f + unit(rng) * 45.0f;
+        l.phase = unit(rng) * 6.2831853f;
+        l.speed = 0.9f * std::pow(11.0f / l.radius, 1.5f);   // same Kepler scaling as the belt
+        l.height = (unit(rng) - 0.5f) * 2.0f;
+        float kind = unit(rng);
+        if (kind < 0.6f) {
+            l.color = glm::vec3(2.0f, 1.6f, 1.0f);
+            l.range = 1.5f + unit(rng);
+            l.blink = 0.0f;
+        } else if (kind < 0.9f) {
+            l.color = unit(rng) < 0.5f ? glm::vec3(3.0f, 0.2f, 0.1f) : glm::vec3(0.2f, 3.0f, 0.4f);
+            l.range = 1.0f + unit(rng);
+            l.blink = 0.5f + unit(rng) * 1.5f;
+        } else {
+            l.color = glm::vec3(3.0f, 4.0f, 6.0f);
+            l.range = 3.0f + 2.0f * unit(rng);
+            l.blink = 0.0f;
+        }
+        lights.push_back(l);
+    }
+    return lights;
+}
+
+// Positions and blink state at simulation time `time`; `out` has one entry per light
+static void moveOrbitLights(const std::vector<OrbitLight>& lights, std::vector<ClusterLight>& out, float time) {
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const OrbitLight& l = lights[i];
+        float a = l.phase + time * l.speed;
+        float on = l.blink > 0.0f ? (std::fmod(time * l.blink, 1.0f) < 0.5f ? 1.0f : 0.0f) : 1.0f;
+        out[i].position = glm::vec3(l.radius * cos(a), l.height, l.radius * sin(a));
+        out[i].range = l.range;
+        out[i].color = l.color * on;
+    }
+}
+
+// albedo array layer of every textured body
+struct SolarLayers {
+    int sun = 0, earth = 0, moon = 0, mercury = 0, venus = 0, mars = 0, phobos = 0, deimos = 0;
+    int saturn = 0, rings = 0, jupiter = 0, uranus = 0, neptune = 0, asteroid = 0;
+};
+
+// Where the bodies are at simulation time `time` (pure math, no GL)
+static std::vector<SceneBody> solarBodies(MeshRange sphereMesh, const SolarLayers& layers, float time) {
+    float earthSpin = time * 50.0f;  // adjust speed as needed
+    float mercurySpin = time * 5.0f;
+    float venusSpin   = time * -1.0f;
+    float marsSpin    = time * 48.0f;
+    //TODO : Double check speeds, I just made up them
+    float jupiterSpin = time * 12.0f;
+    float uranusSpin = time * 13.0f;
+    float saturnSpin = time * 16.0f; 
+    float neptuneSpin = time * 25.0f; 
+
+
+    // earth
+    glm::vec3 earthPosition = glm::vec3(
+        8.0f * cos(time),
+        0.0f,
+        8.0f * sin(time)
+    );
+    float earthScale = 0.5f;
+    // moon
+    glm::vec3 moonPosition = earthPosition + glm::vec3(
+        1.0f * cos(time * 4.0f),
+        0.0f,
+        1.0f * sin(time * 4.0f)
+    );
+    float moonScale = earthScale * 0.27f;
+    
+    // mercury
+    glm::vec3 mercuryPosition = glm::vec3(
+        5.5f * cos(time * 2.0f),
+        0.0f,
+        5.5f * sin(time * 2.0f)
+    );
+    float mercuryScale = earthScale * 0.38f;
+
+    // venus
+    glm::vec3 venusPosition = glm::vec3(
+        6.5f * cos(time * 1.3f),
+        0.0f,
+        6.5f * sin(time * 1.3f)
+    );
+    float venusScale = earthScale * 0.95f;
+
+    // mars
+    glm::vec3 marsPosition = glm::vec3(
+        11.0f * cos(time * 0.9f),
+        0.0f,
+        11.0f * sin(time * 0.9f)
+    );
+    float marsScale = earthScale * 0.53f;
+    
+    glm::vec3 phobosPosition = marsPosition + glm::vec3(
+        0.3f * cos(4.0f * time), // fast orbit
+        0.0f,
+        0.3f * sin(4.0f * time)
+    );
+    float phobosScale = marsScale * 0.05f;
+
+    glm::vec3 deimosPosition = marsPosition + glm::vec3(
+        0.6f * cos(1.0f * time), // slower orbit
+        0.0f,
+        0.6f * sin(1.0f * time)
+    );
+    float deimosScale = marsScale * 0.03f;
+
+    //jupiter, uranus, saturn, neptune
+    //TODO: double check numbers
+    glm::vec3 jupiterPosition = glm::vec3(
+        18.0f * cos(time * 0.5f),
+        0.0f,
+        18.0f * sin(time * 0.5f)
+    );
+    float jupiterScale = earthScale * 11.2f;
+
+    glm::vec3 uranusPosition = glm::vec3(
+        27.0f * cos(time * 0.3f),
+        0.0f,
+        27.0f * sin(time * 0.3f)
+    );
+    float uranusScale = earthScale * 4.0f;
+
+    glm::vec3 saturnPosition = glm::vec3(
+        38.0f * cos(time * 0.4f),
+        0.0f,
+        38.0f * sin(time * 0.4f)
+    );
+    float saturnScale = earthScale * 9.4f;
+
+    glm::vec3 neptunePosition = glm::vec3(
+        48.0f * cos(time * 0.2f),
+        0.0f,
+        48.0f * sin(time * 0.2f)
+    );
+    float neptuneScale = earthScale * 3.9f;
+
+    std::vector<SceneBody> bodies = {
+        { sphereMesh, layers.sun,     glm::vec3(0.0f),  earthScale * 10.0f, 0.0f,        0.0f,   false },
+        { sphereMesh, layers.earth,   earthPosition,    earthScale,         earthSpin,   23.5f },
+        { sphereMesh, layers.moon,    moonPosition,     moonScale },
+        { sphereMesh, layers.mercury, mercuryPosition,  mercuryScale,       mercurySpin, 0.0f },
+        { sphereMesh, layers.venus,   venusPosition,    venusScale,         venusSpin,   177.0f },
+        { sphereMesh, layers.mars,    marsPosition,     marsScale,          marsSpin,    25.0f },
+        { sphereMesh, layers.phobos,  phobosPosition,   phobosScale },
+        { sphereMesh, layers.deimos,  deimosPosition,   deimosScale },
+        //TODO: double check numbers
+        { sphereMesh, layers.jupiter, jupiterPosition,  jupiterScale,       jupiterSpin, 3.0f },
+        { sphereMesh, layers.uranus,  uranusPosition,   uranusScale,        uranusSpin,  97.8f },
+        { sphereMesh, layers.saturn,  saturnPosition,   saturnScale,        saturnSpin,  26.7f },
+        { sphereMesh, layers.neptune, neptunePosition,  neptuneScale,       neptuneSpin, 28.3f },
+    };
+    return bodies;
+}
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef STARTUP_TIMER_H
+#define STARTUP_TIMER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include "Trace.h"
+
+// ------------------------------------------------------------
+// Start-up breakdown: wall and CPU time per phase and per asset
+// ------------------------------------------------------------
+//     { StartupScope phase("mesh arena", "startup"); ... }          // a phase
+//     { StartupScope asset("loadTexture", "load", path); ... }       // inside one
+//
+// beginStartupTimer() at the top of main starts the clock; until
+// finishStartupTimer() (after the first frame is on screen) every
+// StartupScope is kept, nested ones as assets of the phase around them.
+// Outside that window a StartupScope is just its TraceScope, so shaders or
+// textures loaded later (and microbench's parseOBJ loops) cost nothing.
+//
+// CPU time is std::clock(): the whole process, so the driver's compiler
+// threads count too (CPU > wall means work went to other threads). On
+// Windows std::clock() is wall time and the column only repeats it.
+//
+// finishStartupTimer() prints phases and assets sorted by wall time, plus
+// "other" for whatever no phase covered, and returns the total in ms for a
+// --startup-budget check.
+
+struct StartupEntry {
+    const char* name = nullptr;
+    std::string detail;
+    int depth = 0;                 // 0 = phase, deeper = asset
+    double wallMs = 0.0, cpuMs = 0.0;
+};
+
+struct StartupTimerState {
+    bool running = false;
+    std::chrono::steady_clock::time_point start;
+    std::clock_t cpuStart = 0;
+    int depth = 0;
+    std::vector<StartupEntry> entries;
+    double totalMs = 0.0, totalCpuMs = 0.0;   // set by finishStartupTimer()
+};
+
+// inline, not static: ObjLoader.cpp records into the same list
+inline StartupTimerState& startupTimer() {
+    static StartupTimerState state;
+    return state;
+}
+
+inline double startupCpuMs(std::clock_t since) {
+    return (std::clock() - since) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+inline void beginStartupTimer() {
+    StartupTimerState& t = startupTimer();
+    t = StartupTimerState();
+    t.running = true;
+    t.start = std::chrono::steady_clock::now();
+    t.cpuStart = std::clock();
+}
+
+inline bool startupTimerRunning() {
+    return startupTimer().running;
+}
+
+// RAII like TraceScope, and records the same span in the trace
+struct StartupScope {
+    TraceScope trace;
+    long index = -1;               // into the entry list; -1 = not recording
+    std::chrono::steady_clock::time_point start;
+    std::clock_t cpuStart = 0;
+
+    StartupScope(const char* name, const char* category, const char* detail = nullptr)
+        : trace(name, category, detail) {
+        StartupTimerState& t = startupTimer();
+        if (!t.running) return;
+        StartupEntry e;
+        e.name = name;
+        if (detail) e.detail = detail;
+        e.depth = t.depth++;
+        index = (long)t.entries.size();
+        t.entries.push_back(e);
+        start = std::chrono::steady_clock::now();
+        cpuStart = std::clock();
+    }
+    void end() {
+        trace.end();
+        if (index < 0) return;
+        StartupTimerState& t = startupTimer();
+        if (t.running && index < (long)t.entries.size()) {
+            StartupEntry& e = t.entries[index];
+            e.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            e.cpuMs = startupCpuMs(cpuStart);
+            t.depth--;
+        }
+        index = -1;
+    }
+    ~StartupScope() { end(); }
+};
+
+inline void printStartupRows(std::ostream& out, std::vector<const StartupEntry*> rows, double totalMs) {
+    std::sort(rows.begin(), rows.end(),
+              [](const StartupEntry* a, const StartupEntry* b) { return a->wallMs > b->wallMs; });
+    for (const StartupEntry* e : rows) {
+        out << "  " << std::setw(9) << e->wallMs << std::setw(9) << e->cpuMs << std::setw(6)
+            << (totalMs > 0.0 ? 100.0 * e->wallMs / totalMs : 0.0) << "%  " << e->name;
+        if (!e->detail.empty()) out << " " << e->detail;
+        out << std::endl;
+    }
+}
+
+// Stops recording and prints the table; returns the total wall time in ms
+inline double finishStartupTimer(std::ostream& out) {
+    StartupTimerState& t = startupTimer();
+    if (!t.running) return t.totalMs;
+    t.running = false;
+    t.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t.start).count();
+    t.totalCpuMs = startupCpuMs(t.cpuStart);
+
+    std::vector<const StartupEntry*> phases, assets;
+    double phaseMs = 0.0, phaseCpuMs = 0.0;
+    for (const StartupEntry& e : t.entries) {
+        if (e.depth == 0) {
+            phases.push_back(&e);
+            phaseMs += e.wallMs;
+            phaseCpuMs += e.cpuMs;
+        } else {
+            assets.push_back(&e);
+        }
+    }
+    StartupEntry other;
+    other.name = "other";
+    other.wallMs = std::max(0.0, t.totalMs - phaseMs);
+    other.cpuMs = std::max(0.0, t.totalCpuMs - phaseCpuMs);
+    phases.push_back(&other);
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << "startup: " << t.totalMs << " ms to the first frame (" << t.totalCpuMs << " ms CPU)" << std::endl;
+    out << "  " << std::setw(9) << "wall ms" << std::setw(9) << "cpu ms" << std::setw(7) << "share" << "  phase"
+        << std::endl;
+    printStartupRows(out, phases, t.totalMs);
+    if (!assets.empty()) {
+        out << "  " << std::setw(9) << "wall ms" << std::setw(9) << "cpu ms" << std::setw(7) << "share" << "  asset"
+            << std::endl;
+        printStartupRows(out, assets, t.totalMs);
+    }
+    out.flags(flags);
+    out.precision(precision);
+    return t.totalMs;
+}
+
+#endif
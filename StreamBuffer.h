@@ -0,0 +1,140 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include "ResourceTracker.h"
+
+// ------------------------------------------------------------
+// Per-frame streaming ring buffer
+// ------------------------------------------------------------
+// Everything the CPU rewrites every frame (per-draw data, indirect commands,
+// frame uniforms) is sub-allocated from one buffer split into three
+// sections, one per frame in flight.
+//
+// Persistent path (GL 4.4 or ARB_buffer_storage + ARB_texture_buffer_range):
+// the buffer is mapped once, coherent, and written in place. Before a section
+// is reused we wait on the fence placed after the frame that last read it,
+// which with three sections almost never actually blocks.
+//
+// Fallback (plain 3.3): allocations go into a CPU staging copy which
+// flushStream() uploads after orphaning the buffer, so the driver hands us
+// fresh storage instead of syncing. Offsets restart at 0 every frame, so the
+// first allocation of a frame is the one a whole-buffer binding (glTexBuffer
+// without a range) will see.
+//
+// Frame order: beginStreamFrame, streamAlloc..., flushStream, bind/draw,
+// endStreamFrame.
+
+const int STREAM_SECTIONS = 3;
+
+struct StreamAlloc {
+    void* ptr = nullptr;          // write here
+    GLintptr offset = 0;          // bind / draw with this offset into stream.buffer
+    GLsizeiptr size = 0;
+};
+
+struct StreamBuffer {
+    GLuint buffer = 0;
+    bool persistent = false;
+    GLsizeiptr sectionSize = 0;
+    int section = 0;
+    GLsizeiptr used = 0;          // bytes used in the current section
+    unsigned char* mapped = nullptr;
+    std::vector<unsigned char> staging;
+    GLsync fences[STREAM_SECTIONS] = { nullptr, nullptr, nullptr };
+    unsigned long fenceWaits = 0, overflows = 0;   // for reports
+};
+
+static bool streamBufferHasPersistent() {
+    return GLEW_VERSION_4_4 || (GLEW_ARB_buffer_storage && GLEW_ARB_texture_buffer_range);
+}
+
+static void initStreamBuffer(StreamBuffer& stream, GLsizeiptr bytesPerFrame, bool persistent) {
+    stream.persistent = persistent;
+    stream.sectionSize = bytesPerFrame;
+    glGenBuffers(1, &stream.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bytesPerFrame * STREAM_SECTIONS, nullptr, flags);
+        trackBuffer(stream.buffer, bytesPerFrame * STREAM_SECTIONS, "StreamBuffer", "persistent ring", "stream");
+        stream.mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytesPerFrame * STREAM_SECTIONS, flags);
+        if (!stream.mapped) {
+            std::cerr << "StreamBuffer: persistent map failed, orphaning instead" << std::endl;
+            glDeleteBuffers(1, &stream.buffer);
+            untrackBuffer(stream.buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            initStreamBuffer(stream, bytesPerFrame, false);
+            return;
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, bytesPerFrame, nullptr, GL_STREAM_DRAW);
+        stream.staging.resize(bytesPerFrame);
+        trackBuffer(stream.buffer, bytesPerFrame, "StreamBuffer", "orphaned buffer", "stream");
+        trackCpu(&stream, bytesPerFrame, "StreamBuffer", "staging", "stream");
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void beginStreamFrame(StreamBuffer& stream) {
+    stream.used = 0;
+    if (!stream.persistent) return;
+
+    GLsync& fence = stream.fences[stream.section];
+    if (fence) {
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            stream.fenceWaits++;
+            while (result == GL_TIMEOUT_EXPIRED)
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms steps
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+// align: required offset alignment in bytes (GL_*_OFFSET_ALIGNMENT, 4 for indirect commands)
+static StreamAlloc streamAlloc(StreamBuffer& stream, GLsizeiptr size, GLint align) {
+    StreamAlloc alloc;
+    GLsizeiptr start = (stream.used + align - 1) / align * align;
+    if (start + size > stream.sectionSize) {
+        if (stream.overflows++ == 0)
+            std::cerr << "StreamBuffer: frame needs more than " << stream.sectionSize << " bytes" << std::endl;
+        return alloc;
+    }
+    stream.used = start + size;
+
+    GLintptr base = stream.persistent ? (GLintptr)stream.section * stream.sectionSize : 0;
+    alloc.offset = base + start;
+    alloc.size = size;
+    alloc.ptr = stream.persistent ? (void*)(stream.mapped + alloc.offset) : (void*)(stream.staging.data() + start);
+    return alloc;
+}
+
+// copies data into a fresh allocation; returns it (ptr == nullptr on overflow)
+static StreamAlloc streamWrite(StreamBuffer& stream, const void* data, GLsizeiptr size, GLint align) {
+    StreamAlloc alloc = streamAlloc(stream, size, align);
+    if (alloc.ptr) std::memcpy(alloc.ptr, data, size);
+    return alloc;
+}
+
+// After the frame's last allocation, before anything reads from the buffer
+static void flushStream(StreamBuffer& stream) {
+    if (stream.persistent || stream.used == 0) return;   // coherent mapping: nothing to do
+    glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+    glBufferData(GL_ARRAY_BUFFER, stream.sectionSize, nullptr, GL_STREAM_DRAW);   // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, stream.used, stream.staging.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// After the frame's last draw that reads from the buffer
+static void endStreamFrame(StreamBuffer& stream) {
+    if (!stream.persistent) return;
+    stream.fences[stream.section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stream.section = (stream.section + 1) % STREAM_SECTIONS;
+}
+
+#endif
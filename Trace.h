@@ -0,0 +1,189 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+// ------------------------------------------------------------
+// Timeline tracing, exported as Chrome trace JSON
+// ------------------------------------------------------------
+//     { TraceScope trace("loadTexture", "load", path); ... }
+//
+// Off until startTrace() (--trace=file.json). Every thread that records gets
+// its own ring of TRACE_BUFFER_EVENTS events on first use; recording is then
+// just a write into that ring and an atomic store of its counter, no locks.
+// When a ring wraps the oldest events are overwritten, so a flush holds the
+// last ~65k events per thread.
+//
+// flushTrace() writes everything currently held to the trace file; main calls
+// it on T and on exit. It reads the other threads' rings without stopping
+// them, so an event being written during a flush can come out torn (today the
+// render thread is the only one that records).
+//
+// Open the file in chrome://tracing or ui.perfetto.dev. Names and categories
+// must be string literals; the detail (e.g. a file name) is copied.
+
+const int TRACE_BUFFER_EVENTS = 1 << 16;
+const int TRACE_DETAIL_CHARS = 48;
+
+struct TraceEvent {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    char detail[TRACE_DETAIL_CHARS] = {};
+    uint64_t start = 0, duration = 0;   // ns since the trace epoch
+};
+
+struct TraceBuffer {
+    std::vector<TraceEvent> events;     // ring, written by its own thread only
+    std::atomic<uint64_t> written{0};
+    int tid = 0;
+    std::string threadName;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::string path;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::mutex registry;                // taken once per thread and by flushes
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+// inline, not static: ObjLoader.cpp and main.cpp must share the one state
+inline TraceState& traceState() {
+    static TraceState state;
+    return state;
+}
+
+inline bool traceEnabled() {
+    return traceState().enabled.load(std::memory_order_relaxed);
+}
+
+inline uint64_t traceNow() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - traceState().epoch).count();
+}
+
+inline TraceBuffer& traceThreadBuffer() {
+    thread_local TraceBuffer* buffer = nullptr;
+    if (!buffer) {
+        TraceState& state = traceState();
+        std::lock_guard<std::mutex> lock(state.registry);
+        state.buffers.emplace_back(new TraceBuffer());
+        buffer = state.buffers.back().get();
+        buffer->events.resize(TRACE_BUFFER_EVENTS);
+        buffer->tid = (int)state.buffers.size();
+        buffer->threadName = "thread " + std::to_string(buffer->tid);
+    }
+    return *buffer;
+}
+
+// names the calling thread in the trace viewer
+inline void setTraceThreadName(const char* name) {
+    traceThreadBuffer().threadName = name;
+}
+
+inline void startTrace(const std::string& path) {
+    traceState().path = path;
+    traceState().enabled.store(true);
+}
+
+inline void recordTraceEvent(const char* name, const char* category, const char* detail,
+                             uint64_t start, uint64_t end) {
+    if (!traceEnabled()) return;
+    TraceBuffer& buffer = traceThreadBuffer();
+    uint64_t n = buffer.written.load(std::memory_order_relaxed);
+    TraceEvent& e = buffer.events[n % TRACE_BUFFER_EVENTS];
+    e.name = name;
+    e.category = category;
+    if (detail) {
+        std::strncpy(e.detail, detail, TRACE_DETAIL_CHARS - 1);
+        e.detail[TRACE_DETAIL_CHARS - 1] = '\0';
+    } else {
+        e.detail[0] = '\0';
+    }
+    e.start = start;
+    e.duration = end > start ? end - start : 0;
+    buffer.written.store(n + 1, std::memory_order_release);
+}
+
+// RAII span from construction to destruction (or end())
+struct TraceScope {
+    const char* name;
+    const char* category;
+    const char* detail;
+    uint64_t start = 0;
+    bool open;
+    TraceScope(const char* name, const char* category, const char* detail = nullptr)
+        : name(name), category(category), detail(detail), open(traceEnabled()) {
+        if (open) start = traceNow();
+    }
+    void end() {
+        if (!open) return;
+        open = false;
+        recordTraceEvent(name, category, detail, start, traceNow());
+    }
+    ~TraceScope() { end(); }
+};
+
+inline void writeTraceString(FILE* f, const char* s) {
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+// Writes every held event to the trace path; false if tracing is off or the file can't be written
+inline bool flushTrace() {
+    TraceState& state = traceState();
+    if (!traceEnabled()) return false;
+    FILE* f = std::fopen(state.path.c_str(), "w");
+    if (!f) {
+        std::cerr << "Trace: can't write " << state.path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(state.registry);
+    unsigned long count = 0;
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    for (const std::unique_ptr<TraceBuffer>& buffer : state.buffers) {
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                     count++ ? ",\n" : "", buffer->tid);
+        writeTraceString(f, buffer->threadName.c_str());
+        std::fputs("}}", f);
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t first = written > (uint64_t)TRACE_BUFFER_EVENTS ? written - TRACE_BUFFER_EVENTS : 0;
+        for (uint64_t n = first; n < written; ++n) {
+            const TraceEvent& e = buffer->events[n % TRACE_BUFFER_EVENTS];
+            std::fputs(",\n{\"name\":", f);
+            writeTraceString(f, e.name);
+            std::fputs(",\"cat\":", f);
+            writeTraceString(f, e.category);
+            std::fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                         buffer->tid, e.start * 1e-3, e.duration * 1e-3);
+            if (e.detail[0]) {
+                std::fputs(",\"args\":{\"detail\":", f);
+                writeTraceString(f, e.detail);
+                std::fputc('}', f);
+            }
+            std::fputc('}', f);
+            count++;
+        }
+    }
+    std::fputs("\n]}\n", f);
+    std::fclose(f);
+    std::cout << "trace: " << count - state.buffers.size() << " events written to " << state.path << std::endl;
+    return true;
+}
+
+#endif
@@ -0,0 +1,34 @@
+// Asteroid belt instance layout (AsteroidBelt.h): two RGBA16F texels per asteroid
+//   0: orbit radius, orbit phase, angular speed, height above the ecliptic
+//   1: spin axis azimuth, spin axis elevation, spin speed, world radius
+// Everything moves from `time` alone; shared by the culling pass and vertex.glsl.
+uniform samplerBuffer instanceData;
+uniform float time;
+uniform float beltMeshRadius;   // bounding radius of the asteroid mesh at scale 1
+
+vec3 BeltCentre(vec4 orbit) {
+    float a = orbit.y + orbit.z * time;
+    return vec3(orbit.x * cos(a), orbit.w, orbit.x * sin(a));
+}
+
+vec4 InstanceSphere(int i) {
+    vec4 orbit = texelFetch(instanceData, 2 * i);
+    vec4 spin  = texelFetch(instanceData, 2 * i + 1);
+    return vec4(BeltCentre(orbit), spin.w);
+}
+
+mat4 BeltModel(int i) {
+    vec4 orbit = texelFetch(instanceData, 2 * i);
+    vec4 spin  = texelFetch(instanceData, 2 * i + 1);
+
+    vec3 axis = vec3(cos(spin.y) * cos(spin.x), sin(spin.y), cos(spin.y) * sin(spin.x));
+    float angle = spin.z * time;
+    float c = cos(angle), s = sin(angle), t = 1.0 - c;
+    mat3 rot = mat3(t * axis.x * axis.x + c,          t * axis.x * axis.y + s * axis.z, t * axis.x * axis.z - s * axis.y,
+                    t * axis.x * axis.y - s * axis.z, t * axis.y * axis.y + c,          t * axis.y * axis.z + s * axis.x,
+                    t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x, t * axis.z * axis.z + c);
+
+    mat4 model = mat4(rot * (spin.w / beltMeshRadius));
+    model[3] = vec4(BeltCentre(orbit), 1.0);
+    return model;
+}
@@ -0,0 +1,465 @@
+// Renderer benchmark: the solar system scene along scripted camera paths,
+// headless, at fixed simulation times. See README.txt for options.
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "GLDebug.h" // before anything that calls GL
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include "Shader.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "SolarScene.h"
+#include "Golden.h"
+
+// -------------------------------
+// Scripted camera paths
+// -------------------------------
+// Keyframes at fractions of the run, linearly interpolated. Simulation time
+// starts at simStart and advances simStep per frame whatever the frame took,
+// so every run of a path renders exactly the same frames.
+
+struct CameraKey {
+    float at;              // 0..1 along the run
+    glm::vec3 eye, target;
+};
+
+struct CameraPath {
+    const char* name;
+    float simStart;
+    std::vector<CameraKey> keys;
+};
+
+const float BENCH_SIM_STEP = 0.2f / 60.0f;   // main.cpp's 0.2 time scale at 60 fps
+
+static std::vector<CameraPath> benchPaths() {
+    return {
+        // whole system from above, swinging round half an orbit
+        { "overview", 0.0f, {
+            { 0.0f, glm::vec3(0.0f, 25.0f, 60.0f),  glm::vec3(0.0f) },
+            { 0.5f, glm::vec3(60.0f, 20.0f, 0.0f),  glm::vec3(0.0f) },
+            { 1.0f, glm::vec3(0.0f, 25.0f, -60.0f), glm::vec3(0.0f) } } },
+        // --shading=compare's view: low across the belt at the inner planets (overdraw, many lights)
+        { "belt", 3.0f, {
+            { 0.0f, glm::vec3(0.0f, 1.5f, 21.0f),   glm::vec3(0.0f, 0.0f, 0.0f) },
+            { 1.0f, glm::vec3(6.0f, 1.0f, 19.0f),   glm::vec3(-2.0f, 0.0f, 0.0f) } } },
+        // fast pass through the outer system, close to the big planets
+        { "flyby", 7.0f, {
+            { 0.0f, glm::vec3(55.0f, 4.0f, 40.0f),  glm::vec3(0.0f) },
+            { 0.5f, glm::vec3(10.0f, 2.0f, 25.0f),  glm::vec3(-20.0f, 0.0f, 0.0f) },
+            { 1.0f, glm::vec3(-50.0f, 6.0f, 5.0f),  glm::vec3(0.0f) } } },
+    };
+}
+
+static void samplePath(const CameraPath& path, float at, glm::vec3& eye, glm::vec3& target) {
+    const std::vector<CameraKey>& k = path.keys;
+    size_t i = 0;
+    while (i + 2 < k.size() && at > k[i + 1].at) ++i;
+    float span = std::max(k[i + 1].at - k[i].at, 1e-6f);
+    float f = glm::clamp((at - k[i].at) / span, 0.0f, 1.0f);
+    eye = glm::mix(k[i].eye, k[i + 1].eye, f);
+    target = glm::mix(k[i].target, k[i + 1].target, f);
+}
+
+// -------------------------------
+// Options and results
+// -------------------------------
+
+struct BenchOptions {
+    std::vector<std::string> paths;        // empty = all
+    std::vector<glm::ivec2> sizes = { glm::ivec2(800, 600) };
+    int frames = 300;                      // measured frames per path
+    int warmup = 30;                       // rendered first, not measured
+    std::string jsonPath = "bench.json";
+    std::string csvPath;                   // raw frame times, optional
+    std::string goldenDir;                 // reference images + timings (Golden.h), optional
+    bool goldenUpdate = false;             // write them instead of comparing
+    GoldenTolerance tolerance;
+};
+
+struct BenchRun {
+    std::string path;
+    glm::ivec2 size;
+    std::vector<float> frameMs;            // wall time per frame, GPU finished
+    Profiler zones;                        // this run's profiler history
+    ResourceTotals memory;                 // tracked memory of its scene (each size has its own)
+};
+
+struct FrameTimeStats {
+    float min = 0.0f, avg = 0.0f, p50 = 0.0f, p95 = 0.0f, p99 = 0.0f, max = 0.0f;
+};
+
+static FrameTimeStats frameTimeStats(std::vector<float> ms) {
+    FrameTimeStats st;
+    if (ms.empty()) return st;
+    std::sort(ms.begin(), ms.end());
+    auto pct = [&](float p) { return ms[std::min(ms.size() - 1, (size_t)(ms.size() * p))]; };
+    float sum = 0.0f;
+    for (float v : ms) sum += v;
+    st.min = ms.front();
+    st.avg = sum / ms.size();
+    st.p50 = pct(0.5f);
+    st.p95 = pct(0.95f);
+    st.p99 = pct(0.99f);
+    st.max = ms.back();
+    return st;
+}
+
+static std::vector<glm::ivec2> parseSizes(const std::string& list) {
+    std::vector<glm::ivec2> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int w = 0, h = 0;
+        if (std::sscanf(item.c_str(), "%dx%d", &w, &h) == 2 && w > 0 && h > 0) sizes.push_back(glm::ivec2(w, h));
+        else std::cerr << "bench: bad size " << item << std::endl;
+    }
+    return sizes;
+}
+
+// Bench options are taken out; everything else goes to parseRenderSettings
+static BenchOptions parseBenchOptions(int argc, char** argv, std::vector<char*>& rest) {
+    BenchOptions options;
+    rest.push_back(argv[0]);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--path=", 0) == 0) {
+            std::stringstream ss(arg.substr(7));
+            std::string name;
+            while (std::getline(ss, name, ',')) options.paths.push_back(name);
+        } else if (arg.rfind("--size=", 0) == 0) {
+            options.sizes = parseSizes(arg.substr(7));
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            options.frames = std::max(1, std::atoi(arg.c_str() + 9));
+        } else if (arg.rfind("--warmup=", 0) == 0) {
+            options.warmup = std::max(0, std::atoi(arg.c_str() + 9));
+        } else if (arg.rfind("--json=", 0) == 0) {
+            options.jsonPath = arg.substr(7);
+        } else if (arg.rfind("--csv=", 0) == 0) {
+            options.csvPath = arg.substr(6);
+        } else if (arg.rfind("--golden=", 0) == 0) {
+            options.goldenDir = arg.substr(9);
+        } else if (arg == "--golden-update") {
+            options.goldenUpdate = true;
+        } else if (arg.rfind("--golden-threshold=", 0) == 0) {
+            options.tolerance.threshold = (float)std::atof(arg.c_str() + 19);
+        } else if (arg.rfind("--golden-pixels=", 0) == 0) {
+            options.tolerance.maxDiffering = (float)std::atof(arg.c_str() + 16);
+        } else if (arg.rfind("--golden-slowdown=", 0) == 0) {
+            options.tolerance.maxSlowdown = (float)std::atof(arg.c_str() + 18);
+        } else {
+            rest.push_back(argv[i]);
+        }
+    }
+    return options;
+}
+
+static void writeBenchJson(const std::string& file, const std::vector<BenchRun>& runs,
+                           const RenderSettings& settings, const std::string& renderer) {
+    std::ofstream out(file);
+    if (!out) {
+        std::cerr << "bench: can't write " << file << std::endl;
+        return;
+    }
+    // the scene of every size is tracked on its own; the header gives the largest
+    ResourceTotals memory;
+    for (const BenchRun& run : runs) {
+        memory.textures = std::max(memory.textures, run.memory.textures);
+        memory.buffers = std::max(memory.buffers, run.memory.buffers);
+        memory.cpu = std::max(memory.cpu, run.memory.cpu);
+    }
+    out << "{\n  \"renderer\": \"" << renderer << "\",\n"
+        << "  \"asteroids\": " << settings.asteroidCount << ",\n"
+        << "  \"lights\": " << settings.lightCount << ",\n"
+        << "  \"shadows\": \"" << (settings.shadowMode == ShadowMode::Maps ? "maps" : "analytic") << "\",\n"
+        << "  \"shading\": \"" << (settings.shading == ShadingPath::Deferred ? "deferred" : "forward") << "\",\n"
+        << "  \"startup_ms\": " << startupTimer().totalMs << ",\n"
+        << "  \"memory\": { \"texture_bytes\": " << memory.textures << ", \"buffer_bytes\": " << memory.buffers
+        << ", \"cpu_bytes\": " << memory.cpu << " },\n"
+        << "  \"runs\": [";
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const BenchRun& run = runs[r];
+        FrameTimeStats st = frameTimeStats(run.frameMs);
+        out << (r ? "," : "") << "\n    { \"path\": \"" << run.path << "\", \"width\": " << run.size.x
+            << ", \"height\": " << run.size.y << ", \"frames\": " << run.frameMs.size() << ",\n"
+            << "      \"frame_ms\": { \"min\": " << st.min << ", \"avg\": " << st.avg << ", \"p50\": " << st.p50
+            << ", \"p95\": " << st.p95 << ", \"p99\": " << st.p99 << ", \"max\": " << st.max << " },\n"
+            << "      \"memory\": { \"texture_bytes\": " << run.memory.textures << ", \"buffer_bytes\": "
+            << run.memory.buffers << ", \"cpu_bytes\": " << run.memory.cpu << " },\n"
+            << "      \"zones\": [";
+        for (size_t z = 0; z < run.zones.zones.size(); ++z) {
+            const ProfileZone& zone = run.zones.zones[z];
+            ProfileStats zs = profileStats(zone);
+            out << (z ? "," : "") << "\n        { \"name\": \"" << zone.name << "\", \"gpu\": "
+                << (zone.gpu ? "true" : "false") << ", \"min\": " << zs.min << ", \"avg\": " << zs.avg
+                << ", \"p99\": " << zs.p99 << " }";
+        }
+        out << " ] }";
+    }
+    out << "\n  ]\n}\n";
+    std::cout << "bench: results written to " << file << std::endl;
+}
+
+static void writeBenchCsv(const std::string& file, const std::vector<BenchRun>& runs) {
+    std::ofstream out(file);
+    if (!out) {
+        std::cerr << "bench: can't write " << file << std::endl;
+        return;
+    }
+    out << "path,width,height,frame,ms\n";
+    for (const BenchRun& run : runs)
+        for (size_t i = 0; i < run.frameMs.size(); ++i)
+            out << run.path << "," << run.size.x << "," << run.size.y << "," << i << "," << run.frameMs[i] << "\n";
+    std::cout << "bench: frame times written to " << file << std::endl;
+}
+
+// The camera at `at` along the path, simulation time `time`
+static SolarFrame benchFrame(const CameraPath& path, float at, float time, glm::ivec2 size, int fbw, int fbh) {
+    glm::vec3 eye, target;
+    samplePath(path, at, eye, target);
+    SolarFrame frame;
+    frame.eye = eye;
+    frame.view = glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+    frame.projection = glm::perspective(glm::radians(45.0f), (float)size.x / (float)size.y, 0.1f, 100.0f);
+    frame.time = time;
+    frame.sunTime = time;
+    frame.deltaTime = 1.0f / 60.0f;
+    frame.width = fbw;
+    frame.height = fbh;
+    return frame;
+}
+
+// One path at the scene's current size: warm-up frames, then measured ones
+static BenchRun runBenchPath(SolarScene& scene, GLFWwindow* window, const CameraPath& path,
+                             const BenchOptions& options, glm::ivec2 size) {
+    BenchRun run;
+    run.path = path.name;
+    run.size = size;
+    int fbw, fbh;
+    glfwGetFramebufferSize(window, &fbw, &fbh);
+    int total = options.warmup + options.frames;
+    std::unique_ptr<StartupScope> firstFrameTrace;   // the first run's first frame ends the start-up report
+    if (startupTimerRunning()) firstFrameTrace.reset(new StartupScope("first frame", "startup"));
+    for (int f = 0; f < total; ++f) {
+        if (f == options.warmup) resetProfiler(scene.profiler);
+        auto start = std::chrono::steady_clock::now();
+
+        float at = options.frames > 1 ? (float)std::max(0, f - options.warmup) / (options.frames - 1) : 0.0f;
+        renderSolarFrame(scene, benchFrame(path, at, path.simStart + f * BENCH_SIM_STEP, size, fbw, fbh));
+        glDebugEndFrame(f >= options.warmup);
+        CpuZone swapZone(scene.profiler, "swap");
+        glfwSwapBuffers(window);
+        glFinish();   // a frame counts until the GPU is done with it (bench's own sync, not linted)
+        swapZone.end();
+        glfwPollEvents();
+        if (firstFrameTrace) {
+            firstFrameTrace.reset();
+            finishStartupTimer(std::cout);
+        }
+
+        std::chrono::duration<float, std::milli> ms = std::chrono::steady_clock::now() - start;
+        if (f >= options.warmup) run.frameMs.push_back(ms.count());
+    }
+    run.zones = scene.profiler;
+    run.memory = resourceTotals();
+    return run;
+}
+
+// -------------------------------
+// Golden images
+// -------------------------------
+// A path's golden frame is its midpoint one simulated second in, held still
+// for GOLDEN_SETTLE_FRAMES: the shadow caches refresh one cascade and one cube
+// face per frame and occlusion results are two frames late, so by the last
+// frame nothing depends on what ran before. A long deltaTime settles the
+// exposure at once.
+
+const int GOLDEN_SETTLE_FRAMES = 10;
+
+static GoldenImage renderGoldenFrame(SolarScene& scene, GLFWwindow* window, const CameraPath& path,
+                                     glm::ivec2 size) {
+    int fbw, fbh;
+    glfwGetFramebufferSize(window, &fbw, &fbh);
+    SolarFrame frame = benchFrame(path, 0.5f, path.simStart + 1.0f, size, fbw, fbh);
+    frame.deltaTime = 10.0f;
+    GoldenImage image;
+    for (int f = 0; f < GOLDEN_SETTLE_FRAMES; ++f) {
+        renderSolarFrame(scene, frame);
+        glDebugEndFrame(false);
+        if (f + 1 == GOLDEN_SETTLE_FRAMES) image = readGoldenFrame(fbw, fbh);
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+    return image;
+}
+
+// Compares a run's golden frame and average frame time with the stored ones,
+// or with --golden-update records them; false when either is out of tolerance
+static bool checkGolden(const BenchOptions& options, const BenchRun& run, const GoldenImage& image,
+                        const std::string& renderer, const GoldenTimings& stored, GoldenTimings& updated) {
+    std::string name = run.path + "_" + std::to_string(run.size.x) + "x" + std::to_string(run.size.y);
+    std::string base = options.goldenDir + "/" + name;
+    float avgMs = frameTimeStats(run.frameMs).avg;
+    if (options.goldenUpdate) {
+        updated.avgMs[name] = avgMs;
+        return writeGoldenImage(base + ".ppm", image);
+    }
+
+    bool ok = true;
+    GoldenImage expected, diff;
+    if (!readGoldenImage(base + ".ppm", expected)) {
+        std::cerr << "golden: no reference " << base << ".ppm (run with --golden-update)" << std::endl;
+        return false;
+    }
+    GoldenCompare result = compareGoldenImages(expected, image, options.tolerance.threshold, &diff);
+    long allowed = (long)(options.tolerance.maxDiffering * image.width * image.height);
+    if (result.sizeMismatch) {
+        std::cerr << "golden: " << name << " is " << image.width << "x" << image.height << ", the reference "
+                  << expected.width << "x" << expected.height << std::endl;
+        ok = false;
+    } else if (result.differing > allowed) {
+        std::cerr << "golden: " << name << " differs in " << result.differing << " pixels (" << allowed
+                  << " allowed, worst delta " << result.worstDelta << "), see " << base << ".diff.ppm" << std::endl;
+        writeGoldenImage(base + ".actual.ppm", image);
+        writeGoldenImage(base + ".diff.ppm", diff);
+        ok = false;
+    } else {
+        std::cout << "golden: " << name << " matches (" << result.differing << " pixels over the threshold)"
+                  << std::endl;
+    }
+
+    auto reference = stored.avgMs.find(name);
+    if (reference == stored.avgMs.end()) {
+        std::cout << "golden: no stored time for " << name << std::endl;
+    } else if (stored.renderer != renderer) {
+        std::cout << "golden: " << name << " " << avgMs << " ms, stored " << reference->second << " ms on "
+                  << stored.renderer << " (not compared)" << std::endl;
+    } else if (avgMs > reference->second * (1.0f + options.tolerance.maxSlowdown)) {
+        std::cerr << "golden: " << name << " averages " << avgMs << " ms, stored " << reference->second
+                  << " ms (over " << options.tolerance.maxSlowdown * 100.0f << "% slower)" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    beginStartupTimer();
+    std::vector<char*> rest;
+    BenchOptions options = parseBenchOptions(argc, argv, rest);
+    RenderSettings settings = parseRenderSettings((int)rest.size(), rest.data());
+    if (!settings.tracePath.empty()) {
+        startTrace(settings.tracePath);
+        setTraceThreadName("render");
+    }
+
+    std::vector<CameraPath> paths;
+    for (const CameraPath& path : benchPaths()) {
+        bool wanted = options.paths.empty() ||
+                      std::find(options.paths.begin(), options.paths.end(), path.name) != options.paths.end();
+        if (wanted) paths.push_back(path);
+    }
+    if (paths.empty() || options.sizes.empty()) {
+        std::cerr << "bench: nothing to run" << std::endl;
+        return 1;
+    }
+
+    StartupScope glfwTrace("glfwInit", "startup");
+    if (!glfwInit()) {
+        std::cerr << "bench: GLFW init failed" << std::endl;
+        return 1;
+    }
+    glfwTrace.end();
+    std::vector<BenchRun> runs;
+    std::string renderer;
+    GoldenTimings storedTimings, updatedTimings;
+    if (!options.goldenDir.empty())
+        storedTimings = readGoldenTimings(options.goldenDir + "/timings.txt");
+    int goldenFailures = 0;
+    // a fresh hidden window and scene per size, so every size starts from the same state
+    for (glm::ivec2 size : options.sizes) {
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        StartupScope windowTrace("window + GL context", "startup");
+        GLFWwindow* window = glfwCreateWindow(size.x, size.y, "Solar System bench", NULL, NULL);
+        if (window == NULL) {
+            std::cerr << "bench: can't create a " << size.x << "x" << size.y << " window" << std::endl;
+            continue;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+        windowTrace.end();
+        StartupScope glewTrace("glewInit", "startup");
+        if (glewInit() != GLEW_OK) {
+            std::cerr << "bench: GLEW init failed" << std::endl;
+            glfwDestroyWindow(window);
+            continue;
+        }
+        glewTrace.end();
+        renderer = (const char*)glGetString(GL_RENDERER);
+
+        {
+            SolarScene scene;
+            initSolarScene(scene, settings);
+            initGLDebug(settings.glBudget);
+            for (const CameraPath& path : paths) {
+                BenchRun run = runBenchPath(scene, window, path, options, size);
+                printGLDebugReport(std::cout);   // SOLAR_GL_DEBUG builds only
+                FrameTimeStats st = frameTimeStats(run.frameMs);
+                std::cout << path.name << " " << size.x << "x" << size.y << ": avg " << st.avg << " ms, p50 "
+                          << st.p50 << ", p95 " << st.p95 << ", p99 " << st.p99 << ", max " << st.max << std::endl;
+                if (!options.goldenDir.empty() &&
+                    !checkGolden(options, run, renderGoldenFrame(scene, window, path, size), renderer,
+                                 storedTimings, updatedTimings))
+                    goldenFailures++;
+                runs.push_back(run);
+            }
+        }
+        glfwDestroyWindow(window);   // takes the scene's GL objects with the context
+        resetTrackedResources();     // and their names, which the next context hands out again
+    }
+    glfwTerminate();
+
+    writeBenchJson(options.jsonPath, runs, settings, renderer);
+    if (!options.csvPath.empty()) writeBenchCsv(options.csvPath, runs);
+    flushTrace();
+    if (options.goldenUpdate && !options.goldenDir.empty()) {
+        // merge into the stored times so an update of one path or size keeps the rest;
+        // times from another renderer would be compared against this one's, so they go
+        GoldenTimings merged = storedTimings;
+        if (merged.renderer != renderer) {
+            if (!merged.avgMs.empty())
+                std::cout << "golden: timings were from " << merged.renderer << ", dropping "
+                          << merged.avgMs.size() << " of them" << std::endl;
+            merged.renderer = renderer;
+            merged.avgMs.clear();
+        }
+        for (const auto& t : updatedTimings.avgMs) merged.avgMs[t.first] = t.second;
+        writeGoldenTimings(options.goldenDir + "/timings.txt", merged);
+    }
+    if (glDebugBudgetFailures() > 0) {
+        std::cerr << "bench: GL budget exceeded in " << glDebugBudgetFailures() << " frames" << std::endl;
+        return 2;
+    }
+    if (settings.startupBudget > 0.0f && startupTimer().totalMs > settings.startupBudget) {
+        std::cerr << "bench: start-up took " << startupTimer().totalMs << " ms, over the --startup-budget of "
+                  << settings.startupBudget << " ms" << std::endl;
+        return 3;
+    }
+    if (goldenFailures > 0) {
+        std::cerr << "bench: " << goldenFailures << " golden checks failed" << std::endl;
+        return 4;
+    }
+    return runs.empty() ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#version 330 core
+// Transform-feedback culling (GL 3.3 path of GpuCulling.h): one point per instance.
+// InstanceSphere() and instanceData come from the include pasted in above.
+uniform vec4 frustumPlanes[6];
+uniform int instanceCount;
+uniform vec2 cullMargin;   // radius added for the draw's latency: x world units, y per unit of view depth
+
+
+flat out int vIndex;
+flat out int vVisible;
+
+bool SphereVisible(vec4 s) {
+    float depth = max(dot(frustumPlanes[4].xyz, s.xyz) + frustumPlanes[4].w, 0.0);   // past the near plane
+    float radius = s.w + cullMargin.x + cullMargin.y * depth;
+    for (int p = 0; p < 6; ++p)
+        if (dot(frustumPlanes[p].xyz, s.xyz) + frustumPlanes[p].w < -radius) return false;
+    return true;
+}
+
+void main() {
+    vIndex = gl_VertexID;
+    vVisible = (gl_VertexID < instanceCount && SphereVisible(InstanceSphere(gl_VertexID))) ? 1 : 0;
+    gl_Position = vec4(0.0);
+}
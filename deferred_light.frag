@@ -0,0 +1,34 @@
+#version 330 core
+// lighting.glsl is pasted in above (Shader fragment include)
+out vec4 FragColor;
+
+uniform sampler2D gAlbedo;     // DeferredShading.h units
+uniform usampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+
+vec3 OctDecode(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main()
+{
+    ivec2 px = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, px, 0).r;
+    if (depth == 1.0) discard;   // nothing drawn here: the clear colour stays
+    vec4 albedo = texelFetch(gAlbedo, px, 0);
+    uvec4 encoded = texelFetch(gNormal, px, 0);
+
+    // world position from the depth buffer
+    vec4 clip = vec4(gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec3 P = world.xyz / world.w;
+
+    vec3 N = OctDecode(vec2(encoded.xy) / 65535.0);
+    vec3 color = ShadeSurface(albedo.rgb, N, P, int(albedo.a * 255.0 + 0.5), ivec2(encoded.zw));
+    FragColor = vec4(color, 1.0);   // linear HDR, PostProcess.h tonemaps
+}
@@ -0,0 +1,24 @@
+#version 330 core
+// Deferred geometry pass: material only, no lighting (DeferredShading.h)
+layout (location = 0) out vec4 GAlbedo;   // rgb albedo, a = DrawFlags / 255
+layout (location = 1) out uvec4 GNormal;  // octahedral normal (2 x unorm16), first occluder texel, occluder count
+
+in vec2 TexCoord;
+in vec3 FragPos;
+in vec3 Normal;
+flat in vec4 DrawParams;  // albedo layer, flags, first occluder texel, occluder count
+
+uniform sampler2DArray albedoArray; // unit 0
+
+vec2 OctEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return e * 0.5 + 0.5;
+}
+
+void main()
+{
+    GAlbedo = vec4(texture(albedoArray, vec3(TexCoord, DrawParams.x)).rgb, DrawParams.y / 255.0);
+    GNormal = uvec4(uvec2(OctEncode(normalize(Normal)) * 65535.0 + 0.5), uvec2(DrawParams.zw));
+}
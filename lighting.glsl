@@ -0,0 +1,251 @@
+// ------------------------------------------------------------
+// Lighting shared by the forward (fragment.glsl) and deferred
+// (deferred_light.frag) paths; Shader pastes it after their #version line.
+// ------------------------------------------------------------
+#define MAX_CASCADES 4
+
+uniform samplerBuffer drawData;     // per-draw data + occluder spheres, unit 3
+uniform sampler2DArray shadowMap;   // one layer per cascade, bound to texture unit 1
+uniform mat4 lightSpaceMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES]; // view-space depth where each cascade ends
+uniform int cascadeCount;
+layout (std140) uniform FrameData {     // streamed once per frame (StreamBuffer.h, FrameUniforms in SolarScene.h)
+    mat4 viewProjection;
+    mat4 view;
+    vec4 viewPos;
+};
+
+struct DirLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+struct PointLight {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+uniform DirLight  sun;
+uniform PointLight earthLight;
+
+uniform samplerCube earthShadowMap; // distance / earthShadowFar, bound to texture unit 2
+uniform bool earthShadowOn;         // false while earthLight is switched off
+uniform float earthShadowFar;
+
+// analytic mode: eclipse tests against a few spheres instead of shadow maps
+#define MAX_OCCLUDERS 8
+#define PI 3.14159265359
+uniform int shadowMode;               // 0 = shadow maps, 1 = analytic spheres
+uniform float sunAngularRadius;       // radians
+uniform float earthLightRadius;       // world units
+
+// clustered point lights (ClusteredLights.h): only the fragment's cluster is looped over
+#define MAX_LIGHTS_PER_CLUSTER 32
+uniform samplerBuffer lightData;      // 2 texels per light: position + range, colour; unit 5
+uniform usamplerBuffer clusterLights; // per cluster: first index, count; unit 6
+uniform usamplerBuffer lightIndices;  // unit 7
+uniform vec3 clusterGrid;             // tiles x, tiles y, depth slices
+uniform vec4 clusterParams;           // tile width/height in pixels, slice = log(depth) * z + w
+
+vec3 CalcDirLight(DirLight light, vec3 N, vec3 V, vec3 albedo) {
+    vec3 L = normalize(-light.direction);
+    float diff = max(dot(N, L), 0.0);
+    vec3 R = reflect(-L, N);
+    float spec = pow(max(dot(V, R), 0.0), 32.0);
+    vec3 ambient  = light.ambient * albedo;
+    vec3 diffuse  = light.diffuse * diff * albedo;
+    vec3 specular = light.specular * spec;
+    return ambient + diffuse + specular;
+}
+
+vec3 CalcPointLight(PointLight L, vec3 N, vec3 P, vec3 V, vec3 albedo, float shadow) {
+    vec3 toL = L.position - P;
+    float d  = length(toL);
+    vec3  l  = toL / max(d, 1e-6);
+
+    float diff = max(dot(N, l), 0.0);
+    vec3  R    = reflect(-l, N);
+    float spec = pow(max(dot(V, R), 0.0), 32.0);
+
+    float att = 1.0 / (L.constant + L.linear * d + L.quadratic * d * d);
+
+    vec3 ambient  = L.ambient  * albedo;
+    vec3 diffuse  = L.diffuse  * diff * albedo;
+    vec3 specular = L.specular * spec;
+    return (ambient + (diffuse + specular) * (1.0 - shadow)) * att;
+}
+
+float PointShadowFactor(vec3 worldPos, vec3 N, vec3 lightPos)
+{
+    vec3 fromLight = worldPos - lightPos;
+    float current = length(fromLight);
+    if (current >= earthShadowFar) return 0.0; // beyond the cube map's range
+
+    vec3 l = fromLight / max(current, 1e-6);
+    float bias = 0.02 + 0.05 * (1.0 - max(dot(N, -l), 0.0));
+
+    // 4 taps around the lookup direction
+    float radius = current * 2.0 / float(textureSize(earthShadowMap, 0).x);
+    vec3 t = normalize(cross(l, abs(l.y) < 0.99 ? vec3(0, 1, 0) : vec3(1, 0, 0)));
+    vec3 b = cross(l, t);
+    float shadow = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        vec2 o = vec2((i & 1) == 0 ? -0.5 : 0.5, (i & 2) == 0 ? -0.5 : 0.5);
+        vec3 dir = fromLight + (t * o.x + b * o.y) * radius;
+        float closest = texture(earthShadowMap, dir).r * earthShadowFar;
+        shadow += (current - bias > closest) ? 1.0 : 0.0;
+    }
+    return shadow * 0.25;
+}
+
+float ShadowFactor(vec3 worldPos, vec3 N, vec3 Lsun)
+{
+    // pick the cascade by view depth
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    int layer = cascadeCount - 1;
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (viewDepth <= cascadeSplits[i]) { layer = i; break; }
+    }
+
+    // project to [0,1]
+    vec4 fragPosLightSpace = lightSpaceMatrices[layer] * vec4(worldPos, 1.0);
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    projCoords = projCoords * 0.5 + 0.5;
+
+    if (projCoords.z > 1.0) return 0.0; // outside light frustum
+
+    // bias (reduce acne)
+    float ndotl = max(dot(N, Lsun), 0.0);
+    float bias  = max(0.0005, 0.005 * (1.0 - ndotl));
+
+    // 3x3 PCF
+    float shadow = 0.0;
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    for (int x = -1; x <= 1; ++x)
+    for (int y = -1; y <= 1; ++y) {
+        float pcfDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x,y) * texelSize, float(layer))).r;
+        shadow += (projCoords.z - bias > pcfDepth) ? 1.0 : 0.0;
+    }
+    shadow /= 9.0;
+    return shadow;
+}
+
+// area of the intersection of two disks (radii r1, r2, centres d apart)
+float DiskOverlap(float r1, float r2, float d)
+{
+    if (d >= r1 + r2) return 0.0;
+    if (d <= abs(r1 - r2)) return PI * min(r1, r2) * min(r1, r2);
+    float a = r1 * r1 * acos(clamp((d * d + r1 * r1 - r2 * r2) / (2.0 * d * r1), -1.0, 1.0));
+    float b = r2 * r2 * acos(clamp((d * d + r2 * r2 - r1 * r1) / (2.0 * d * r2), -1.0, 1.0));
+    float c = 0.5 * sqrt(max((-d + r1 + r2) * (d + r1 - r2) * (d - r1 + r2) * (d + r1 + r2), 0.0));
+    return a + b - c;
+}
+
+// fraction of a light disk (angular radius lightAngle, towards L) hidden by one sphere
+// closer than maxDist
+float SphereOcclusion(vec3 P, vec3 L, float lightAngle, float maxDist, vec4 sph)
+{
+    vec3 d = sph.xyz - P;
+    float dist = length(d);
+    if (dist <= sph.w || dist - sph.w > maxDist) return 0.0; // inside it / behind the light
+    vec3 dn = d / dist;
+    float occAngle = asin(sph.w / dist);
+    float sep = atan(length(cross(dn, L)), dot(dn, L));
+    if (sep >= lightAngle + occAngle) return 0.0;
+    float la = max(lightAngle, 1e-4);
+    return min(DiskOverlap(la, occAngle, sep) / (PI * la * la), 1.0);
+}
+
+float AnalyticShadow(vec3 P, vec3 L, float lightAngle, float maxDist, ivec2 occluders)
+{
+    // occluders (xyz = centre, w = radius) are picked per body on the CPU:
+    // first texel in drawData, count
+    int first = occluders.x;
+    int count = min(occluders.y, MAX_OCCLUDERS);
+    float lit = 1.0;
+    for (int i = 0; i < count; ++i)
+        lit *= 1.0 - SphereOcclusion(P, L, lightAngle, maxDist, texelFetch(drawData, first + i));
+    return 1.0 - lit;
+}
+
+vec3 CalcClusterLights(vec3 N, vec3 P, vec3 V, vec3 albedo)
+{
+    float viewDepth = max(-(view * vec4(P, 1.0)).z, 1e-4);
+    ivec3 grid = ivec3(clusterGrid);
+    ivec3 cell = ivec3(gl_FragCoord.xy / clusterParams.xy, log(viewDepth) * clusterParams.z + clusterParams.w);
+    cell = clamp(cell, ivec3(0), grid - 1);
+    uvec2 range = texelFetch(clusterLights, (cell.z * grid.y + cell.y) * grid.x + cell.x).rg;
+
+    vec3 result = vec3(0.0);
+    for (uint k = 0u; k < min(range.y, uint(MAX_LIGHTS_PER_CLUSTER)); ++k) {
+        int l = int(texelFetch(lightIndices, int(range.x + k)).r);
+        vec4 posRange = texelFetch(lightData, l * 2);
+        vec3 color    = texelFetch(lightData, l * 2 + 1).rgb;
+
+        vec3 toL = posRange.xyz - P;
+        float d  = length(toL);
+        if (d >= posRange.w) continue;
+        vec3 Ld = toL / max(d, 1e-6);
+
+        // inverse square, windowed to reach exactly zero at the light's range
+        float window = 1.0 - pow(d / posRange.w, 4.0);
+        float att = window * window / (d * d + 1.0);
+
+        float diff = max(dot(N, Ld), 0.0);
+        float spec = pow(max(dot(V, reflect(-Ld, N)), 0.0), 32.0);
+        result += color * (diff * albedo + spec) * att;
+    }
+    return result;
+}
+
+// Everything a surface point receives: sun + shadow, earthLight + shadow, the
+// clustered lights, the Sun's own glow. flags = DrawFlags, occluders = first
+// drawData texel and count (analytic mode). Returns linear colour.
+vec3 ShadeSurface(vec3 albedo, vec3 N, vec3 P, int flags, ivec2 occluders)
+{
+    bool isSun   = (flags & 1) != 0;   // DRAW_SUN
+    bool isEarth = (flags & 2) != 0;   // DRAW_EARTH
+    vec3 V = normalize(viewPos.xyz - P);
+
+    // Sun (directional) + its shadow
+    vec3 Lsun = normalize(-sun.direction);
+    vec3 sunTerm = CalcDirLight(sun, N, V, albedo);
+    float shadow = 0.0;
+    if (!isSun) {
+        shadow = (shadowMode == 1) ? AnalyticShadow(P, Lsun, sunAngularRadius, 1e9, occluders)
+                                   : ShadowFactor(P, N, Lsun);
+    }
+
+    // emissive for the Sun so it looks self-lit
+    vec3 outColor = sunTerm * (1.0 - shadow);
+    if (isSun) {
+    outColor += albedo * vec3(2.0); // emissive boost; tweak to taste
+    }
+
+    // Earth point light (optionally make Earth uniformly lit by itself)
+    float earthShadow = 0.0;
+    if (earthShadowOn && !isEarth && !isSun) {
+        if (shadowMode == 1) {
+            vec3 toLight = earthLight.position - P;
+            float dist = length(toLight);
+            float angle = asin(min(earthLightRadius / max(dist, 1e-4), 1.0));
+            earthShadow = AnalyticShadow(P, toLight / max(dist, 1e-4), angle, dist, occluders);
+        } else {
+            earthShadow = PointShadowFactor(P, N, earthLight.position);
+        }
+    }
+    vec3 earthTerm = CalcPointLight(earthLight, N, P, V, albedo, earthShadow);
+    if (isEarth) {
+        earthTerm = earthLight.diffuse * albedo + earthLight.ambient * albedo;
+    }
+    outColor += earthTerm;
+
+    if (!isSun) outColor += CalcClusterLights(N, P, V, albedo);
+    return outColor;
+}
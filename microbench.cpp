@@ -0,0 +1,282 @@
+// Microbenchmarks for the CPU-side kernels: mesh generators, OBJ parsing,
+// image decoding, orbit math and model matrices. No GL context is created;
+// nothing benchmarked here calls GL. See README.txt for options.
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "ObjLoader.h"
+#include "PlanetRenderer.h"
+#include "SolarSystem.h"
+
+// -------------------------------
+// Harness
+// -------------------------------
+// Google Benchmark's shape without the dependency: a benchmark body loops on
+// `while (state.keepRunning())`, the harness grows the iteration count until a
+// run lasts at least minTime, then reports time per iteration and, when the
+// body sets `items`, throughput. Each benchmark has a list of arguments (the
+// sweep) and sees the current one as state.arg.
+
+struct MicroState {
+    long long arg = 0;
+    long long items = 0;          // work items per iteration (vertices, bodies, bytes ...)
+    std::string label;            // extra column, e.g. image size
+    long long iterations = 0;     // to run this time
+    long long done = 0;
+    bool keepRunning() { return done++ < iterations; }
+};
+
+struct MicroBenchmark {
+    std::string name;
+    void (*fn)(MicroState&);
+    std::vector<long long> args;
+};
+
+// keeps the compiler from dropping a result nobody reads
+template <class T>
+static void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct MicroResult {
+    std::string name;
+    long long arg = 0;
+    long long iterations = 0;
+    double nsPerIteration = 0.0;
+    double itemsPerSecond = 0.0;
+    std::string label;
+};
+
+static MicroResult runMicroBenchmark(const MicroBenchmark& bench, long long arg, double minTime) {
+    MicroState state;
+    state.arg = arg;
+    state.iterations = 1;
+    bench.fn(state);   // warm-up: caches, page cache, lazy allocations
+
+    double seconds = 0.0;
+    for (long long n = 1;;) {
+        state.iterations = n;
+        state.done = 0;
+        auto start = std::chrono::steady_clock::now();
+        bench.fn(state);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds >= minTime || n >= (1LL << 40)) break;
+        // aim a little past minTime, growing at most 10x per attempt
+        double scale = seconds > 0.0 ? std::min(minTime / seconds * 1.2, 10.0) : 10.0;
+        n = std::max(n + 1, (long long)(n * scale));
+    }
+
+    MicroResult result;
+    result.name = bench.name;
+    result.arg = arg;
+    result.iterations = state.iterations;
+    result.nsPerIteration = seconds * 1e9 / state.iterations;
+    result.itemsPerSecond = state.items ? state.items * state.iterations / seconds : 0.0;
+    result.label = state.label;
+    return result;
+}
+
+// -------------------------------
+// Benchmarks
+// -------------------------------
+
+// arg = sectors; stacks = sectors / 2 like the default 64 x 32
+static void benchSphereMesh(MicroState& state) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    while (state.keepRunning()) {
+        generateSphereMesh(vertices, indices, (int)state.arg, (int)state.arg / 2);
+        doNotOptimize(vertices.data());
+    }
+    state.items = (long long)vertices.size() / 8;
+    state.label = std::to_string(indices.size() / 3) + " tris";
+}
+
+// arg = segments
+static void benchRingMesh(MicroState& state) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    while (state.keepRunning()) {
+        generateRingMesh(vertices, indices, 0.54f, 1.0f, (int)state.arg);
+        doNotOptimize(vertices.data());
+    }
+    state.items = (long long)vertices.size() / 8;
+    state.label = std::to_string(indices.size() / 3) + " tris";
+}
+
+static std::vector<std::string> microTempFiles;   // removed at exit
+
+// A UV sphere written as OBJ text (v / vt / vn / f with shared indices), so
+// parseOBJ can be swept over file size; arg = sectors
+static std::string writeSphereObj(int sectors) {
+    std::string path = "microbench_sphere_" + std::to_string(sectors) + ".obj";
+    for (const std::string& written : microTempFiles)
+        if (written == path) return path;
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    generateSphereMesh(vertices, indices, sectors, sectors / 2);
+    std::ofstream out(path);
+    microTempFiles.push_back(path);
+    for (size_t v = 0; v < vertices.size(); v += 8)
+        out << "v " << vertices[v] << " " << vertices[v + 1] << " " << vertices[v + 2] << "\n";
+    for (size_t v = 0; v < vertices.size(); v += 8)
+        out << "vt " << vertices[v + 3] << " " << vertices[v + 4] << "\n";
+    for (size_t v = 0; v < vertices.size(); v += 8)
+        out << "vn " << vertices[v + 5] << " " << vertices[v + 6] << " " << vertices[v + 7] << "\n";
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        out << "f";
+        for (int k = 0; k < 3; ++k) {
+            unsigned int n = indices[i + k] + 1;
+            out << " " << n << "/" << n << "/" << n;
+        }
+        out << "\n";
+    }
+    return path;
+}
+
+static long long fileSize(const std::string& path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    return f.good() ? (long long)f.tellg() : 0;
+}
+
+// arg = sphere sectors, 0 = Asteroid/Asteroid.obj
+static void benchParseObj(MicroState& state) {
+    std::string path = state.arg ? writeSphereObj((int)state.arg) : "Asteroid/Asteroid.obj";
+    std::vector<float> interleaved;
+    std::vector<GLuint> indices;
+    float radius = 0.0f;
+    while (state.keepRunning()) {
+        parseOBJ(path, interleaved, indices, radius);
+        doNotOptimize(interleaved.data());
+    }
+    state.items = fileSize(path);   // bytes/s
+    state.label = path + " " + std::to_string(state.items / 1024) + " KB";
+}
+
+// arg = index into the images below, smallest file first
+static const char* MICRO_IMAGES[] = {
+    "uranus_texture.jpg", "deimos_texture.jpg", "earth_texture.jpg",
+    "saturnRings_texture.png", "mercury_texture.jpg",
+};
+
+// loadTexture without the GL upload
+static void benchImageDecode(MicroState& state) {
+    const char* path = MICRO_IMAGES[state.arg];
+    int width = 0, height = 0, channels = 0;
+    stbi_set_flip_vertically_on_load(true);
+    while (state.keepRunning()) {
+        unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+        doNotOptimize(data);
+        stbi_image_free(data);
+    }
+    state.items = (long long)width * height;   // pixels/s
+    state.label = std::string(path) + " " + std::to_string(width) + "x" + std::to_string(height) + ", " +
+                  std::to_string(fileSize(path) / 1024) + " KB";
+}
+
+// the scene's per-frame orbit math: all 12 bodies at a new time each iteration
+static void benchSolarBodies(MicroState& state) {
+    SolarLayers layers;
+    MeshRange sphere;
+    float time = 0.0f;
+    std::vector<SceneBody> bodies;
+    while (state.keepRunning()) {
+        bodies = solarBodies(sphere, layers, time);
+        doNotOptimize(bodies.data());
+        time += 0.0033f;
+    }
+    state.items = (long long)bodies.size();
+}
+
+// arg = lights; the orbiting point lights moved every frame
+static void benchOrbitLights(MicroState& state) {
+    std::vector<OrbitLight> lights = scatterOrbitLights((int)state.arg);
+    std::vector<ClusterLight> out(lights.size());
+    float time = 0.0f;
+    while (state.keepRunning()) {
+        moveOrbitLights(lights, out, time);
+        doNotOptimize(out.data());
+        time += 0.0033f;
+    }
+    state.items = state.arg;
+}
+
+// arg = bodies; planetModelMatrix for each, as the draw lists do
+static void benchModelMatrices(MicroState& state) {
+    std::vector<glm::mat4> models(state.arg);
+    float time = 0.0f;
+    while (state.keepRunning()) {
+        for (long long i = 0; i < state.arg; ++i)
+            models[i] = planetModelMatrix(glm::vec3(8.0f * cos(time + i), 0.0f, 8.0f * sin(time + i)),
+                                          0.5f, time * 50.0f, 23.5f);
+        doNotOptimize(models.data());
+        time += 0.0033f;
+    }
+    state.items = state.arg;
+}
+
+static std::vector<MicroBenchmark> microBenchmarks() {
+    return {
+        { "generateSphereMesh", benchSphereMesh,    { 16, 32, 64, 128, 256, 512 } },
+        { "generateRingMesh",   benchRingMesh,      { 32, 128, 512, 2048 } },
+        { "parseOBJ",           benchParseObj,      { 0, 16, 64, 256 } },
+        { "stbi_load",          benchImageDecode,   { 0, 1, 2, 3, 4 } },
+        { "solarBodies",        benchSolarBodies,   { 12 } },
+        { "moveOrbitLights",    benchOrbitLights,   { 64, 256, 1024, 4096, 16384 } },
+        { "planetModelMatrix",  benchModelMatrices, { 1, 12, 64, 512, 4096 } },
+    };
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minTime = 0.25;
+    std::string csvPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) filter = arg.substr(9);
+        else if (arg.rfind("--min-time=", 0) == 0) minTime = std::max(0.001, std::atof(arg.c_str() + 11));
+        else if (arg.rfind("--csv=", 0) == 0) csvPath = arg.substr(6);
+        else std::cerr << "Unknown option: " << arg << std::endl;
+    }
+
+    std::vector<MicroResult> results;
+    std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(14) << "ns/iter"
+              << std::setw(12) << "iters" << std::setw(16) << "items/s" << "  " << std::endl;
+    for (const MicroBenchmark& bench : microBenchmarks()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        for (long long arg : bench.args) {
+            MicroResult r = runMicroBenchmark(bench, arg, minTime);
+            std::string name = bench.name + "/" + std::to_string(arg);
+            std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(14) << r.nsPerIteration << std::setw(12) << r.iterations
+                      << std::setw(16) << std::setprecision(0) << r.itemsPerSecond << "  " << r.label << std::endl;
+            results.push_back(r);
+        }
+    }
+
+    if (!csvPath.empty()) {
+        std::ofstream out(csvPath);
+        out << "benchmark,arg,iterations,ns_per_iteration,items_per_second,label\n";
+        for (const MicroResult& r : results)
+            out << r.name << "," << r.arg << "," << r.iterations << "," << r.nsPerIteration << ","
+                << r.itemsPerSecond << ",\"" << r.label << "\"\n";
+    }
+    for (const std::string& path : microTempFiles) std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,16 @@
+#version 330 core
+// Stats overlay: font atlas texel over a translucent backing
+out vec4 FragColor;
+
+in vec2 CellPos;
+flat in uint Glyph;
+flat in uint Colour;
+
+uniform sampler2D fontAtlas;   // R8, glyph cells of 6x8 side by side, row 0 at the top
+
+void main() {
+    ivec2 texel = min(ivec2(CellPos), ivec2(5, 7));
+    float ink = texelFetch(fontAtlas, ivec2(int(Glyph) * 6 + texel.x, texel.y), 0).r;
+    vec3 colour = Colour == 1u ? vec3(1.0, 0.45, 0.35) : vec3(0.85, 1.0, 0.85);
+    FragColor = mix(vec4(0.0, 0.0, 0.0, 0.55), vec4(colour, 1.0), ink);
+}
@@ -0,0 +1,22 @@
+#version 330 core
+// Stats overlay (Overlay.h): one instance per character, its cell's quad from gl_VertexID
+layout (location = 0) in uvec4 aChar;   // column, row, glyph, colour
+
+uniform vec2 screenSize;    // framebuffer pixels
+uniform float pixelScale;   // screen pixels per font texel
+
+out vec2 CellPos;           // font texels inside the 6x8 cell, y down
+flat out uint Glyph;
+flat out uint Colour;
+
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+                               vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+void main() {
+    CellPos = corners[gl_VertexID] * vec2(6.0, 8.0);
+    // 4 texel margin from the top-left corner
+    vec2 pixel = (vec2(4.0) + vec2(aChar.xy) * vec2(6.0, 8.0) + CellPos) * pixelScale;
+    gl_Position = vec4(pixel.x / screenSize.x * 2.0 - 1.0, 1.0 - pixel.y / screenSize.y * 2.0, 0.0, 1.0);
+    Glyph = aChar.z;
+    Colour = aChar.w;
+}
@@ -0,0 +1,15 @@
+#version 330 core
+in vec3 FragPos;
+in vec2 TexCoord;
+flat in vec2 DrawParams;  // albedo layer, flags
+
+uniform vec3 lightPos;
+uniform float farPlane;
+uniform sampler2DArray albedoArray;
+
+void main() {
+    // gl_FragDepth already rules out early-z here, so the alpha test costs nothing extra
+    if ((int(DrawParams.y) & 4) != 0 &&   // DRAW_ALPHA_TEST
+        texture(albedoArray, vec3(TexCoord, DrawParams.x)).a < 0.5) discard;
+    gl_FragDepth = length(FragPos - lightPos) / farPlane; // linear distance, same on every face
+}
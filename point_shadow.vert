@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 3) in uint aDrawID;
+
+uniform samplerBuffer drawData;   // see vertex.glsl
+uniform mat4 lightSpaceMatrix; // projection * view of one cube face
+
+out vec3 FragPos;
+out vec2 TexCoord;
+flat out vec2 DrawParams;      // albedo layer, flags
+
+void main() {
+    int base = int(aDrawID) * 5;
+    mat4 model = mat4(texelFetch(drawData, base),     texelFetch(drawData, base + 1),
+                      texelFetch(drawData, base + 2), texelFetch(drawData, base + 3));
+    DrawParams = texelFetch(drawData, base + 4).xy;
+    TexCoord = aTexCoord;
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    FragPos = worldPos.xyz;
+    gl_Position = lightSpaceMatrix * worldPos;
+}
@@ -0,0 +1,17 @@
+#version 330 core
+// 1x1 adapted luminance (PostProcess.h): eases last frame's value towards the
+// average at the top of the luminance pyramid
+out float FragColor;
+
+uniform sampler2D luminance;   // RG16F pyramid from post_luminance.frag
+uniform sampler2D previous;    // last frame's result, 0 before the first frame
+uniform float topLevel;
+uniform float adaptAmount;     // 1 - exp(-dt * rate)
+
+void main()
+{
+    vec2 avg = textureLod(luminance, vec2(0.5), topLevel).rg;
+    float target = avg.y > 1e-4 ? exp(avg.x / avg.y) : 0.2;   // nothing lit on screen: a dim default
+    float prev = texelFetch(previous, ivec2(0), 0).r;
+    FragColor = prev > 0.0 ? mix(prev, target, adaptAmount) : target;
+}
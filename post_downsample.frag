@@ -0,0 +1,25 @@
+#version 330 core
+// Bloom downsample (PostProcess.h): four bilinear taps = a 4x4 box of the
+// source. The first level also keeps only what is brighter than threshold.
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform vec2 targetSize;
+uniform bool prefilter;
+uniform float threshold;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / targetSize;
+    vec2 texel = 1.0 / vec2(textureSize(source, 0));
+    vec3 c = 0.25 * (texture(source, uv + texel * vec2(-1.0, -1.0)).rgb +
+                     texture(source, uv + texel * vec2( 1.0, -1.0)).rgb +
+                     texture(source, uv + texel * vec2(-1.0,  1.0)).rgb +
+                     texture(source, uv + texel * vec2( 1.0,  1.0)).rgb);
+    if (prefilter) {
+        c = min(c, vec3(64.0));   // single hot pixels shouldn't turn into big blobs
+        float brightness = max(c.r, max(c.g, c.b));
+        c *= max(brightness - threshold, 0.0) / max(brightness, 1e-4);
+    }
+    FragColor = vec4(c, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+// Top of the auto-exposure pyramid (PostProcess.h): weighted log luminance of
+// the scene at 256x256. Empty space (the clear colour) gets weight 0 so the
+// black sky doesn't drag the exposure up; mipmapping then averages both.
+out vec2 FragColor;   // log luminance * weight, weight
+
+uniform sampler2D scene;
+
+void main()
+{
+    vec3 c = texture(scene, gl_FragCoord.xy / 256.0).rgb;
+    float lum = dot(c, vec3(0.2126, 0.7152, 0.0722));
+    float weight = lum > 0.02 ? 1.0 : 0.0;
+    FragColor = vec2(log(max(lum, 1e-4)) * weight, weight);
+}
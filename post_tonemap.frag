@@ -0,0 +1,21 @@
+#version 330 core
+// Final pass (PostProcess.h): scene + bloom, auto exposure, Reinhard, gamma
+out vec4 FragColor;
+
+uniform sampler2D scene;
+uniform sampler2D bloom;
+uniform sampler2D adaptedLuminance;
+uniform float bloomStrength;
+uniform float exposureKey;     // what the adapted average luminance is mapped to
+
+void main()
+{
+    vec2 size = vec2(textureSize(scene, 0));
+    vec3 hdr = texelFetch(scene, ivec2(gl_FragCoord.xy), 0).rgb;
+    hdr += bloomStrength * texture(bloom, gl_FragCoord.xy / size).rgb;
+
+    float exposure = clamp(exposureKey / texelFetch(adaptedLuminance, ivec2(0), 0).r, 0.25, 4.0);
+    vec3 c = hdr * exposure;
+    c = c / (c + vec3(1.0));
+    FragColor = vec4(pow(c, vec3(1.0/2.2)), 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+// Bloom upsample (PostProcess.h): 3x3 tent of the smaller level, added onto
+// the larger one with ONE/ONE blending
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform vec2 targetSize;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / targetSize;
+    vec2 texel = 1.0 / vec2(textureSize(source, 0));
+    vec3 c = 4.0 * texture(source, uv).rgb;
+    c += 2.0 * (texture(source, uv + vec2(texel.x, 0.0)).rgb + texture(source, uv - vec2(texel.x, 0.0)).rgb +
+                texture(source, uv + vec2(0.0, texel.y)).rgb + texture(source, uv - vec2(0.0, texel.y)).rgb);
+    c += texture(source, uv + texel).rgb + texture(source, uv - texel).rgb +
+         texture(source, uv + vec2(texel.x, -texel.y)).rgb + texture(source, uv + vec2(-texel.x, texel.y)).rgb;
+    FragColor = vec4(c / 16.0, 1.0);
+}
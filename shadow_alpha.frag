@@ -0,0 +1,11 @@
+#version 330 core
+// depth only, alpha-tested casters (rings); kept apart from shadow_depth.frag
+// so the opaque depth passes never contain a discard
+in vec2 TexCoord;
+flat in float AlbedoLayer;
+
+uniform sampler2DArray albedoArray;
+
+void main() {
+    if (texture(albedoArray, vec3(TexCoord, AlbedoLayer)).a < 0.5) discard;
+}
@@ -1,9 +1,21 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 3) in uint aDrawID;
 
-uniform mat4 model;
-uniform mat4 lightSpaceMatrix;
+uniform samplerBuffer drawData;   // see vertex.glsl
+uniform mat4 lightSpaceMatrix;   // cascade matrix, or viewProjection for the depth pre-pass
+
+out vec2 TexCoord;               // only read by shadow_alpha.frag
+flat out float AlbedoLayer;
+invariant gl_Position;           // same expression as vertex.glsl so LEQUAL matches exactly
 
 void main() {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    int base = int(aDrawID) * 5;
+    mat4 model = mat4(texelFetch(drawData, base),     texelFetch(drawData, base + 1),
+                      texelFetch(drawData, base + 2), texelFetch(drawData, base + 3));
+    TexCoord = aTexCoord;
+    AlbedoLayer = texelFetch(drawData, base + 4).x;
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    gl_Position = lightSpaceMatrix * worldPos;
 }
@@ -2,24 +2,42 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormal;
+layout (location = 3) in uint aDrawID;   // per-instance, = baseInstance (DrawList.h)
+layout (location = 4) in uint aInstance; // belt pass: visible asteroid index (GpuCulling.h)
 
-uniform mat4 lightSpaceMatrix;
-out vec4 FragPosLightSpace;
-
-uniform mat4 model, view, projection;
+layout (std140) uniform FrameData {     // streamed once per frame (StreamBuffer.h, FrameUniforms in SolarScene.h)
+    mat4 viewProjection;
+    mat4 view;
+    vec4 viewPos;
+};
+uniform samplerBuffer drawData;          // 5 texels per draw: model columns, then params
+uniform bool beltPass;                   // BeltModel() comes from belt_instance.glsl
+uniform float beltLayer;
 
 out vec2 TexCoord;
 out vec3 FragPos;
 out vec3 Normal;
+flat out vec4 DrawParams;                // albedo layer, flags, first occluder texel, occluder count
+invariant gl_Position;                   // must match the depth pre-pass bit for bit (shadow_depth.vert)
 
 void main() {
+    mat4 model;
+    if (beltPass) {
+        model = BeltModel(int(aInstance));
+        DrawParams = vec4(beltLayer, 0.0, 0.0, 0.0);
+    } else {
+        int base = int(aDrawID) * 5;
+        model = mat4(texelFetch(drawData, base),     texelFetch(drawData, base + 1),
+                     texelFetch(drawData, base + 2), texelFetch(drawData, base + 3));
+        DrawParams = texelFetch(drawData, base + 4);
+    }
+
     vec4 worldPos = model * vec4(aPos, 1.0);
-    FragPosLightSpace = lightSpaceMatrix * worldPos;
     FragPos = worldPos.xyz;
 
     mat3 normalMatrix = transpose(inverse(mat3(model)));
     Normal = normalize(normalMatrix * aNormal);
 
     TexCoord = aTexCoord;
-    gl_Position = projection * view * worldPos;
+    gl_Position = viewProjection * worldPos;
 }